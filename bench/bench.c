@@ -0,0 +1,468 @@
+/*******************************************************************************
+* bench.c: this file is a benchmark for the libcfg library.
+
+* libcfg: C library for parsing command line option and configuration files.
+
+* Github repository:
+        https://github.com/cheng-zhao/libcfg
+
+* Copyright (c) 2019 Cheng Zhao <zhaocheng03@gmail.com>
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+*******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "libcfg.h"
+
+/* Default settings of the benchmark. */
+#define DEFAULT_NUM             100000  /* number of entries per workload */
+#define DEFAULT_REPEAT          11      /* number of timed runs */
+#define DEFAULT_DIR             "/tmp"  /* directory for generated files */
+/* Settings of the synthetic workloads. */
+#define ARRAY_FACTOR            10      /* array elements per entry */
+#define CONTINUE_LEN            16      /* elements of multi-line arrays */
+#define COMMENT_LINES           8       /* comment lines per entry */
+/* Priority of parameters from different sources. */
+#define PRIOR_CMD               2
+#define PRIOR_FILE              1
+
+/* Print the error messages and exit. */
+#define EXIT_ERROR(cfg) {                                               \
+  cfg_perror(cfg, stderr, "Error:");                                    \
+  exit(1);                                                              \
+}
+
+/* Synthetic workloads. */
+typedef enum {
+  BENCH_SCALAR,         /* scalars of all data types */
+  BENCH_ARRAY,          /* huge numerical arrays */
+  BENCH_CONTINUE,       /* arrays with line continuations */
+  BENCH_COMMENT,        /* long comment blocks */
+  BENCH_QUOTE,          /* heavily quoted strings */
+  BENCH_ARGV,           /* large command line vectors */
+  BENCH_NUM_WORK
+} bench_kind_t;
+
+static const char *bench_name[BENCH_NUM_WORK] = {
+  "scalar", "array", "continue", "comment", "quote", "argv"
+};
+
+/* Storage for the variables of all data types. */
+typedef union {
+  bool b;
+  char c;
+  int i;
+  long l;
+  float f;
+  double d;
+  void *p;
+} bench_var_t;
+
+/* Data structure of a generated workload. */
+typedef struct {
+  bench_kind_t kind;    /* type of the workload */
+  int npar;             /* number of registered parameters */
+  size_t nent;          /* number of entries, or array elements */
+  size_t size;          /* number of bytes of the input */
+  cfg_param_t *param;   /* registered parameters */
+  bench_var_t *var;     /* variables of the parameters */
+  char *names;          /* names and long options of the parameters */
+  char *fname;          /* name of the configuration file */
+  int argc;             /* number of command line arguments */
+  char **argv;          /* command line arguments, modified by the parser */
+  char *args;           /* original command line arguments */
+} bench_work_t;
+
+/* Data types of scalar entries, used in turn. */
+static const cfg_dtype_t bench_dtype[7] = {
+  CFG_DTYPE_BOOL, CFG_DTYPE_CHAR, CFG_DTYPE_INT, CFG_DTYPE_LONG,
+  CFG_DTYPE_FLT, CFG_DTYPE_DBL, CFG_DTYPE_STR
+};
+
+/* A function that prints help messages. */
+void help(void *pname) {
+  printf("Usage: %s [OPTION [VALUE]]\n\
+  -n, --num\n\
+        Set the number of entries per workload (default: %d).\n\
+  -r, --repeat\n\
+        Set the number of timed runs (default: %d).\n\
+  -d, --dir\n\
+        Set the directory for the generated files (default: %s).\n\
+  -w, --workloads\n\
+        Set the workloads to be run, e.g. [scalar,argv], from: scalar,\n\
+        array, continue, comment, quote, argv (default: all).\n\
+  -k, --keep\n\
+        Keep the generated configuration files.\n\
+  -h, --help\n\
+        Display this message and exit.\n", (char *) pname, DEFAULT_NUM,
+      DEFAULT_REPEAT, DEFAULT_DIR);
+  exit(0);
+}
+
+/* Get the current time in seconds. */
+static double bench_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Print the value of a scalar entry, according to its data type. */
+static void bench_value(FILE *fp, const cfg_dtype_t dtype, const size_t i) {
+  static const char *bools[6] = {"T", "true", "1", "f", "FALSE", "0"};
+  switch (dtype) {
+    case CFG_DTYPE_BOOL: fprintf(fp, "%s", bools[i % 6]); break;
+    case CFG_DTYPE_CHAR: fprintf(fp, "%c", (char) ('a' + i % 26)); break;
+    case CFG_DTYPE_INT:  fprintf(fp, "%d", (int) (i % 2000003) - 1000001);
+                         break;
+    case CFG_DTYPE_LONG: fprintf(fp, "%ld", (long) i * 2654435761L); break;
+    case CFG_DTYPE_FLT:  fprintf(fp, "%.7g", i * 0.37 - 1e3); break;
+    case CFG_DTYPE_DBL:  fprintf(fp, "%.17g", i * 1.0e-3 / 7.0); break;
+    default:             fprintf(fp, "value_%zu", i); break;
+  }
+}
+
+/* Register a parameter of the workload. */
+static void bench_param(bench_work_t *w, char **pos, const int i,
+    const char *prefix, const cfg_dtype_t dtype) {
+  w->param[i].name = *pos;
+  *pos += sprintf(*pos, "%s%d", prefix, i) + 1;
+  w->param[i].dtype = dtype;
+  w->param[i].var = w->var + i;
+}
+
+/* Generate a configuration file for the workload. */
+static void bench_gen_file(bench_work_t *w, const size_t num,
+    const char *dir) {
+  size_t i, j;
+  w->fname = malloc(strlen(dir) + 32);
+  sprintf(w->fname, "%s/libcfg_bench_%s.conf", dir, bench_name[w->kind]);
+  FILE *fp = fopen(w->fname, "w");
+  if (!fp) {
+    fprintf(stderr, "Error: cannot write to file: %s\n", w->fname);
+    exit(1);
+  }
+
+  char *pos = w->names;
+  switch (w->kind) {
+    case BENCH_SCALAR:
+      for (i = 0; i < num; i++) {
+        bench_param(w, &pos, i, "s", bench_dtype[i % 7]);
+        fprintf(fp, "%s = ", w->param[i].name);
+        bench_value(fp, bench_dtype[i % 7], i);
+        fprintf(fp, "\n");
+      }
+      w->nent = num;
+      break;
+    case BENCH_ARRAY:
+      bench_param(w, &pos, 0, "x", CFG_ARRAY_DBL);
+      bench_param(w, &pos, 1, "y", CFG_ARRAY_INT);
+      fprintf(fp, "x0 = [");
+      for (i = 0; i < num * ARRAY_FACTOR; i++)
+        fprintf(fp, "%s%.9g", i ? ", " : "", i * 0.001 - 3.5e3);
+      fprintf(fp, "]\ny1 = [");
+      for (i = 0; i < num * ARRAY_FACTOR; i++)
+        fprintf(fp, "%s%d", i ? "," : "", (int) (i * 7919 % 2000003));
+      fprintf(fp, "]\n");
+      w->nent = 2 * num * ARRAY_FACTOR;
+      break;
+    case BENCH_CONTINUE:
+      for (i = 0; i < (size_t) w->npar; i++) {
+        bench_param(w, &pos, i, "c", CFG_ARRAY_DBL);
+        fprintf(fp, "%s = [", w->param[i].name);
+        for (j = 0; j < CONTINUE_LEN; j++)
+          fprintf(fp, "%s%.6g", j ? ", \\\n    " : "", (i + j) * 0.25);
+        fprintf(fp, "]\n");
+      }
+      w->nent = (size_t) w->npar * CONTINUE_LEN;
+      break;
+    case BENCH_COMMENT:
+      for (i = 0; i < num; i++) {
+        bench_param(w, &pos, i, "m", CFG_DTYPE_INT);
+        for (j = 0; j < COMMENT_LINES; j++)
+          fprintf(fp, "# Comment line %zu of entry %zu, with symbols "
+              "= [ ] , ' \" that are ignored.\n", j, i);
+        fprintf(fp, "%s = %zu    # trailing comment\n", w->param[i].name, i);
+      }
+      w->nent = num;
+      break;
+    case BENCH_QUOTE:
+      for (i = 0; i < num; i++) {
+        if (i & 1) {
+          bench_param(w, &pos, i, "q", CFG_ARRAY_STR);
+          fprintf(fp, "%s = ['x, y %zu', \"p # q\", 'z = [1]', \"'a'\"]\n",
+              w->param[i].name, i);
+        }
+        else {
+          bench_param(w, &pos, i, "q", CFG_DTYPE_STR);
+          fprintf(fp, "%s = \"a, b = [c] # 'd' %zu\"\n", w->param[i].name, i);
+        }
+      }
+      w->nent = num;
+      break;
+    default:
+      break;
+  }
+
+  /* Make sure that the file can be evicted from the page cache. */
+  if (fflush(fp) || fsync(fileno(fp))) {
+    fprintf(stderr, "Error: cannot write to file: %s\n", w->fname);
+    exit(1);
+  }
+  w->size = ftell(fp);
+  fclose(fp);
+}
+
+/* Generate the command line arguments for the workload. */
+static void bench_gen_argv(bench_work_t *w, const size_t num) {
+  size_t i, len = 0;
+  char *pos = w->names;
+  for (i = 0; i < num; i++) {
+    bench_param(w, &pos, i, "o", bench_dtype[i % 7]);
+    w->param[i].lopt = w->param[i].name;
+  }
+
+  /* Options are given as "--name=value" and "--name value" in turn. */
+  FILE *fp = tmpfile();
+  if (!fp) {
+    fprintf(stderr, "Error: failed to create a temporary file.\n");
+    exit(1);
+  }
+  w->argc = 1;
+  fprintf(fp, "bench%c", '\0');
+  for (i = 0; i < num; i++) {
+    fprintf(fp, "--%s%c", w->param[i].name, (i & 1) ? '\0' : '=');
+    bench_value(fp, bench_dtype[i % 7], i);
+    fprintf(fp, "%c", '\0');
+    w->argc += (i & 1) ? 2 : 1;
+  }
+  len = ftell(fp);
+  rewind(fp);
+  w->args = malloc(len * 2);
+  w->argv = malloc(sizeof(char *) * w->argc);
+  if (!w->args || !w->argv || fread(w->args, len, 1, fp) != 1) {
+    fprintf(stderr, "Error: failed to generate the arguments.\n");
+    exit(1);
+  }
+  fclose(fp);
+  w->size = len;
+  w->nent = num;
+}
+
+/* Generate a workload. */
+static void bench_gen(bench_work_t *w, const bench_kind_t kind,
+    const size_t num, const char *dir) {
+  memset(w, 0, sizeof(bench_work_t));
+  w->kind = kind;
+  w->npar = (kind == BENCH_ARRAY) ? 2 :
+    (kind == BENCH_CONTINUE) ? (num + CONTINUE_LEN - 1) / CONTINUE_LEN : num;
+  w->param = calloc(w->npar, sizeof(cfg_param_t));
+  w->var = calloc(w->npar, sizeof(bench_var_t));
+  w->names = malloc((size_t) w->npar * 16);
+  if (!w->param || !w->var || !w->names) {
+    fprintf(stderr, "Error: failed to allocate memory for the workload.\n");
+    exit(1);
+  }
+  if (kind == BENCH_ARGV) bench_gen_argv(w, num);
+  else bench_gen_file(w, num, dir);
+}
+
+/* Drop the file from the page cache, if supported by the system. */
+static bool bench_evict(const char *fname) {
+  const int fd = open(fname, O_RDONLY);
+  if (fd == -1) return false;
+  const int err = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+  return !err;
+}
+
+/* Reset the command line arguments that are modified by the parser. */
+static void bench_reset_argv(bench_work_t *w) {
+  char *copy = w->args + w->size;
+  memcpy(copy, w->args, w->size);
+  for (int i = 0; i < w->argc; i++) {
+    w->argv[i] = copy;
+    copy += strlen(copy) + 1;
+  }
+}
+
+/* Compare function for sorting the timings. */
+static int bench_cmp(const void *a, const void *b) {
+  const double x = *((const double *) a);
+  const double y = *((const double *) b);
+  return (x > y) - (x < y);
+}
+
+/* Print the throughput and latency percentiles of a stage. */
+static void bench_report(const bench_work_t *w, const char *stage,
+    double *t, const int n, const size_t size, const size_t nent) {
+  qsort(t, n, sizeof(double), bench_cmp);
+  const double med = t[(n - 1) / 2];
+  const double p90 = t[(int) (0.9 * n + 0.999) - 1];
+  const double p99 = t[(int) (0.99 * n + 0.999) - 1];
+  char rate[32] = "-";
+  if (size) sprintf(rate, "%.2f", size / med / 1e6);
+  printf("%-9s %-16s %10s %11.2f %12.3f %10.3f %10.3f %10.3f\n",
+      bench_name[w->kind], stage, rate, nent / med / 1e6, med * 1e3,
+      p90 * 1e3, p99 * 1e3, t[n - 1] * 1e3);
+}
+
+/* Run the stages of a workload. */
+static void bench_run(bench_work_t *w, const int nrep) {
+  double *tpar = malloc(sizeof(double) * nrep * 3);
+  if (!tpar) {
+    fprintf(stderr, "Error: failed to allocate memory for the timings.\n");
+    exit(1);
+  }
+  double *twarm = tpar + nrep;
+  double *tcold = twarm + nrep;
+  bool cold = true;
+
+  /* The first run warms up the page cache and memory allocator. */
+  for (int r = -1; r < nrep; r++) {
+    for (int pass = 0; pass < 2; pass++) {
+      if (pass && (w->kind == BENCH_ARGV || !cold)) break;
+      cfg_t *cfg = cfg_init();
+      if (!cfg) {
+        fprintf(stderr, "Error: failed to initialise the configurations.\n");
+        exit(1);
+      }
+      if (cfg_use_arena(cfg)) EXIT_ERROR(cfg);
+      double t0 = bench_time();
+      if (cfg_set_params(cfg, w->param, w->npar)) EXIT_ERROR(cfg);
+      double t1 = bench_time();
+      if (w->kind == BENCH_ARGV) {
+        int optidx;
+        bench_reset_argv(w);
+        t1 = bench_time();
+        if (cfg_read_opts(cfg, w->argc, w->argv, PRIOR_CMD, &optidx))
+          EXIT_ERROR(cfg);
+      }
+      else {
+        if (pass && !(cold = bench_evict(w->fname))) {
+          cfg_destroy(cfg);
+          break;
+        }
+        t1 = bench_time();
+        if (cfg_read_file(cfg, w->fname, PRIOR_FILE)) EXIT_ERROR(cfg);
+      }
+      const double t2 = bench_time();
+      cfg_destroy(cfg);
+      if (r < 0) continue;
+      if (pass) tcold[r] = t2 - t1;
+      else {
+        tpar[r] = t1 - t0;
+        twarm[r] = t2 - t1;
+      }
+    }
+  }
+
+  bench_report(w, "set_params", tpar, nrep, 0, w->npar);
+  if (w->kind == BENCH_ARGV)
+    bench_report(w, "read_opts", twarm, nrep, w->size, w->nent);
+  else {
+    bench_report(w, "read_file/warm", twarm, nrep, w->size, w->nent);
+    if (cold) bench_report(w, "read_file/cold", tcold, nrep, w->size, w->nent);
+    else printf("%-9s %-16s %s\n", bench_name[w->kind], "read_file/cold",
+        "page cache eviction is not supported");
+  }
+  free(tpar);
+}
+
+/* Release the memory of a workload. */
+static void bench_free(bench_work_t *w, const bool keep) {
+  if (w->fname) {
+    if (!keep) remove(w->fname);
+    free(w->fname);
+  }
+  free(w->param);
+  free(w->var);
+  free(w->names);
+  if (w->argv) free(w->argv);
+  if (w->args) free(w->args);
+}
+
+int main(int argc, char *argv[]) {
+  int optidx, num = DEFAULT_NUM, nrep = DEFAULT_REPEAT;
+  char *dir = DEFAULT_DIR;
+  char **works = NULL;
+  bool keep = false;
+
+  const cfg_func_t funcs[1] = {
+    {   'h',    "help",         help,           argv[0] }
+  };
+  const cfg_param_t params[5] = {
+    {   'n',    "num",          "NUM",          CFG_DTYPE_INT,  &num    },
+    {   'r',    "repeat",       "REPEAT",       CFG_DTYPE_INT,  &nrep   },
+    {   'd',    "dir",          "DIR",          CFG_DTYPE_STR,  &dir    },
+    {   'w',    "workloads",    "WORKLOADS",    CFG_ARRAY_STR,  &works  },
+    {   'k',    "keep",         "KEEP",         CFG_DTYPE_BOOL, &keep   }
+  };
+
+  /* Parse the command line options with the library itself. */
+  cfg_t *cfg = cfg_init();
+  if (!cfg) {
+    fprintf(stderr, "Error: failed to initialise the configurations.\n");
+    return 1;
+  }
+  if (cfg_set_funcs(cfg, funcs, 1) || cfg_set_params(cfg, params, 5) ||
+      cfg_read_opts(cfg, argc, argv, PRIOR_CMD, &optidx)) EXIT_ERROR(cfg);
+  cfg_pwarn(cfg, stderr, "Warning:");
+  if (num <= 0 || nrep <= 0) {
+    fprintf(stderr, "Error: invalid number of entries or runs.\n");
+    return 1;
+  }
+
+  bool run[BENCH_NUM_WORK];
+  const int nwork = cfg_get_size(cfg, &works);
+  for (int i = 0; i < BENCH_NUM_WORK; i++) run[i] = (nwork == 0);
+  for (int i = 0; i < nwork; i++) {
+    int j;
+    for (j = 0; j < BENCH_NUM_WORK; j++)
+      if (!strcmp(works[i], bench_name[j])) break;
+    if (j == BENCH_NUM_WORK) {
+      fprintf(stderr, "Error: unknown workload: %s\n", works[i]);
+      return 1;
+    }
+    run[j] = true;
+  }
+
+  printf("%-9s %-16s %10s %11s %12s %10s %10s %10s\n", "workload", "stage",
+      "MB/s", "Mentries/s", "p50(ms)", "p90(ms)", "p99(ms)", "max(ms)");
+  for (int i = 0; i < BENCH_NUM_WORK; i++) {
+    if (!run[i]) continue;
+    bench_work_t w;
+    bench_gen(&w, i, num, dir);
+    bench_run(&w, nrep);
+    bench_free(&w, keep);
+  }
+
+  if (cfg_is_set(cfg, &dir)) free(dir);
+  if (nwork) {
+    free(*works);
+    free(works);
+  }
+  cfg_destroy(cfg);
+  return 0;
+}
@@ -0,0 +1,389 @@
+/*******************************************************************************
+* conv.c: this file is a microbenchmark for the value conversions of the
+          libcfg library.
+
+* libcfg: C library for parsing command line option and configuration files.
+
+* Github repository:
+        https://github.com/cheng-zhao/libcfg
+
+* Copyright (c) 2019 Cheng Zhao <zhaocheng03@gmail.com>
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+*******************************************************************************/
+
+#ifdef BENCH_ENABLE_PERF
+#define _GNU_SOURCE             /* for `syscall` */
+#else
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+/* The converters are static, so the library is compiled with the benchmark,
+   and they are measured without the file reader and the tokenizer. */
+#include "../libcfg.c"
+#include <time.h>
+#ifdef BENCH_ENABLE_PERF
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/* Settings of the benchmark. */
+#define CONV_MIN_TIME           0.05    /* minimum seconds per measurement */
+#define CONV_ARRAY_LEN          4096    /* number of elements of arrays */
+#define CONV_MAX_VALUE_LEN      64      /* maximum length of scalar values */
+#define CONV_MAX_CASE_LEN       16      /* maximum number of inputs per set */
+#define CONV_NUM_COUNTER        3       /* number of hardware counters */
+
+/* Storage for the variables of all data types. */
+typedef union {
+  bool b;
+  char c;
+  int i;
+  long l;
+  float f;
+  double d;
+  char *s;
+} conv_var_t;
+
+/* Set of typical inputs for a data type. */
+typedef struct {
+  cfg_dtype_t dtype;            /* data type of the inputs */
+  const char *label;            /* description of the inputs */
+  int num;                      /* number of inputs */
+  const char *const *val;       /* the inputs */
+} conv_case_t;
+
+static const char *const conv_bool[] = {"1", "0", "T", "t", "true", "TRUE",
+  "True", "F", "f", "false", "FALSE", "False"};
+static const char *const conv_char[] = {"a", "Z", "7", "'q'", "\"#\""};
+static const char *const conv_int_short[] = {"0", "7", "42", "-3", "+15",
+  "999"};
+static const char *const conv_int_long[] = {"2147483647", "-2147483648",
+  "1234567890", "-987654321"};
+static const char *const conv_long_long[] = {"9223372036854775807",
+  "-9223372036854775808", "1234567890123456789", "-31415926535897932"};
+static const char *const conv_decimal[] = {"3.14159", "-0.5", "123.456",
+  "0.001", "-98765.4321", "2.0"};
+static const char *const conv_exp_flt[] = {"6.02214076e23", "1E-30",
+  "-2.5e+10", "7e0", "1.17549435e-38"};
+static const char *const conv_exp_dbl[] = {"6.02214076e23", "1E-300",
+  "-2.5e+10", "7e0", "2.2250738585072014e-308", "1.7976931348623157e308"};
+static const char *const conv_long_dec[] = {"0.12345678901234567890",
+  "3.141592653589793238462643", "-2.718281828459045235360287"};
+static const char *const conv_special[] = {"inf", "-INF", "Infinity", "nan",
+  "NaN", "-nan"};
+static const char *const conv_str[] = {"plain_value", "x",
+  "\"quoted, with # symbols\"", "'single [quoted] = value'"};
+
+#define CONV_CASE(dtype, label, val)    \
+  {dtype, label, sizeof(val) / sizeof(val[0]), val}
+
+static const conv_case_t conv_cases[] = {
+  CONV_CASE(CFG_DTYPE_BOOL, "all spellings", conv_bool),
+  CONV_CASE(CFG_DTYPE_CHAR, "plain and quoted", conv_char),
+  CONV_CASE(CFG_DTYPE_INT, "short", conv_int_short),
+  CONV_CASE(CFG_DTYPE_INT, "long", conv_int_long),
+  CONV_CASE(CFG_DTYPE_LONG, "short", conv_int_short),
+  CONV_CASE(CFG_DTYPE_LONG, "long", conv_long_long),
+  CONV_CASE(CFG_DTYPE_FLT, "decimal", conv_decimal),
+  CONV_CASE(CFG_DTYPE_FLT, "exponent", conv_exp_flt),
+  CONV_CASE(CFG_DTYPE_FLT, "long decimal", conv_long_dec),
+  CONV_CASE(CFG_DTYPE_FLT, "inf/nan", conv_special),
+  CONV_CASE(CFG_DTYPE_DBL, "decimal", conv_decimal),
+  CONV_CASE(CFG_DTYPE_DBL, "exponent", conv_exp_dbl),
+  CONV_CASE(CFG_DTYPE_DBL, "long decimal", conv_long_dec),
+  CONV_CASE(CFG_DTYPE_DBL, "inf/nan", conv_special),
+  CONV_CASE(CFG_DTYPE_STR, "plain and quoted", conv_str)
+};
+
+static const char *conv_dtype_name[] = {"", "bool", "char", "int", "long",
+  "float", "double", "string"};
+
+/* Get the current time in seconds. */
+static double conv_time(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*============================================================================*\
+                  Hardware counters (with BENCH_ENABLE_PERF)
+\*============================================================================*/
+
+typedef struct {
+  int fd[CONV_NUM_COUNTER];     /* file descriptors of the counters */
+  long long val[CONV_NUM_COUNTER];      /* counts of the last measurement */
+} conv_perf_t;
+
+/* Open the hardware counters, which are disabled if not supported. */
+static void conv_perf_init(conv_perf_t *perf) {
+#ifdef BENCH_ENABLE_PERF
+  const unsigned long long config[CONV_NUM_COUNTER] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+  for (int i = 0; i < CONV_NUM_COUNTER; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(struct perf_event_attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(struct perf_event_attr);
+    attr.config = config[i];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf->fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+#else
+  for (int i = 0; i < CONV_NUM_COUNTER; i++) perf->fd[i] = -1;
+#endif
+}
+
+/* Start or stop the counters. */
+static void conv_perf_switch(conv_perf_t *perf, const bool start) {
+#ifdef BENCH_ENABLE_PERF
+  for (int i = 0; i < CONV_NUM_COUNTER; i++) {
+    if (perf->fd[i] == -1) continue;
+    if (start) {
+      ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+    else {
+      ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+      if (read(perf->fd[i], perf->val + i, sizeof(long long)) !=
+          sizeof(long long)) perf->val[i] = -1;
+    }
+  }
+#else
+  (void) perf;
+  (void) start;
+#endif
+}
+
+/* Print the counts per element. */
+static void conv_perf_print(const conv_perf_t *perf, const double num) {
+  for (int i = 0; i < CONV_NUM_COUNTER; i++) {
+    if (perf->fd[i] == -1 || perf->val[i] < 0) printf(" %9s", "-");
+    else printf(" %9.2f", perf->val[i] / num);
+  }
+}
+
+/*============================================================================*\
+                       Reference conversions for checking
+\*============================================================================*/
+
+/* Remove the quotation marks of an input. */
+static void conv_unquote(const char *in, char *out) {
+  const size_t len = strlen(in);
+  if (len >= 2 && (in[0] == '"' || in[0] == '\'') && in[len - 1] == in[0]) {
+    memcpy(out, in + 1, len - 2);
+    out[len - 2] = '\0';
+  }
+  else strcpy(out, in);
+}
+
+/* Check a converted value bit by bit, against the C standard library. */
+static bool conv_check(const cfg_dtype_t dtype, const char *in,
+    const void *var) {
+  char str[CONV_MAX_VALUE_LEN];
+  conv_unquote(in, str);
+  switch (dtype) {
+    case CFG_DTYPE_BOOL:
+      return *((const bool *) var) == (strchr("1Tt", str[0]) != NULL);
+    case CFG_DTYPE_CHAR:
+      return *((const char *) var) == str[0];
+    case CFG_DTYPE_INT:
+      return *((const int *) var) == (int) strtol(str, NULL, 10);
+    case CFG_DTYPE_LONG:
+      return *((const long *) var) == strtol(str, NULL, 10);
+    case CFG_DTYPE_FLT: {
+      const float ref = strtof(str, NULL);
+      const float val = *((const float *) var);
+      if (isnan(ref)) return isnan(val);
+      return !memcmp(&ref, &val, sizeof(float));
+    }
+    case CFG_DTYPE_DBL: {
+      const double ref = strtod(str, NULL);
+      const double val = *((const double *) var);
+      if (isnan(ref)) return isnan(val);
+      return !memcmp(&ref, &val, sizeof(double));
+    }
+    case CFG_DTYPE_STR:
+      return !strcmp(*((char *const *) var), str);
+    default:
+      return false;
+  }
+}
+
+/*============================================================================*\
+                            Benchmarks of conversions
+\*============================================================================*/
+
+/* Measure `cfg_get_value` on the scalar inputs, and return the number of
+   mismatches. */
+static int conv_scalar(const conv_case_t *c, conv_perf_t *perf) {
+  char buf[CONV_MAX_CASE_LEN][CONV_MAX_VALUE_LEN];
+  char sbuf[CONV_MAX_VALUE_LEN];
+  size_t len[CONV_MAX_CASE_LEN];
+  bool quoted[CONV_MAX_CASE_LEN];
+  conv_var_t var;
+  int i, nbad = 0;
+
+  /* Check the results first. */
+  for (i = 0; i < c->num; i++) {
+    len[i] = strlen(c->val[i]) + 1;
+    quoted[i] = (c->val[i][0] == '"' || c->val[i][0] == '\'');
+    memcpy(buf[i], c->val[i], len[i]);
+    var.s = sbuf;
+    if (cfg_get_value(&var, buf[i], len[i], c->dtype, 1) ||
+        !conv_check(c->dtype, c->val[i], &var)) {
+      if (!nbad++) printf("  mismatch: %s %s\n", conv_dtype_name[c->dtype],
+          c->val[i]);
+    }
+    memcpy(buf[i], c->val[i], len[i]);
+  }
+
+  /* Quoted inputs are modified by the converter, and restored. */
+  size_t iter = 1, n;
+  double t;
+  for (;;) {
+    conv_perf_switch(perf, true);
+    t = conv_time();
+    for (n = 0; n < iter; n++) {
+      for (i = 0; i < c->num; i++) {
+        var.s = sbuf;
+        cfg_get_value(&var, buf[i], len[i], c->dtype, 1);
+        if (quoted[i]) memcpy(buf[i], c->val[i], len[i]);
+      }
+    }
+    t = conv_time() - t;
+    conv_perf_switch(perf, false);
+    if (t >= CONV_MIN_TIME) break;
+    iter <<= 1;
+  }
+
+  const double num = (double) iter * c->num;
+  printf("%-6s %-7s %-17s %9.2f", "scalar", conv_dtype_name[c->dtype],
+      c->label, t / num * 1e9);
+  conv_perf_print(perf, num);
+  printf("  %s\n", nbad ? "FAIL" : "ok");
+  return nbad;
+}
+
+/* Measure `cfg_get_array` on arrays of the inputs, and return the number of
+   mismatches. */
+static int conv_array(const conv_case_t *c, cfg_t *cfg, conv_perf_t *perf) {
+  size_t len = 2, i;
+  for (i = 0; i < CONV_ARRAY_LEN; i++) len += strlen(c->val[i % c->num]) + 2;
+  char *orig = malloc(len + 1);
+  char *buf = malloc(len + 1);
+  if (!orig || !buf) {
+    fprintf(stderr, "Error: failed to allocate memory for the arrays.\n");
+    exit(1);
+  }
+  char *p = orig;
+  *p++ = CFG_SYM_ARRAY_START;
+  for (i = 0; i < CONV_ARRAY_LEN; i++) {
+    if (i) {
+      *p++ = CFG_SYM_ARRAY_SEP;
+      *p++ = ' ';
+    }
+    p += sprintf(p, "%s", c->val[i % c->num]);
+  }
+  *p++ = CFG_SYM_ARRAY_END;
+  *p = '\0';
+  len = p - orig + 1;
+
+  void *arr = NULL;
+  cfg_param_valid_t par;
+  memset(&par, 0, sizeof(cfg_param_valid_t));
+  par.dtype = c->dtype + CFG_ARRAY_BOOL - CFG_DTYPE_BOOL;
+  par.name = "ARRAY";
+  par.nlen = strlen(par.name) + 1;
+  par.value = buf;
+  par.vlen = len;
+  par.var = &arr;
+
+  /* Check the results first. */
+  int nbad = 0;
+  memcpy(buf, orig, len);
+  if (cfg_get_array(cfg, &par, 1) || par.narr != CONV_ARRAY_LEN) nbad = 1;
+  else {
+    const size_t size = cfg_dtype_size(c->dtype);
+    for (i = 0; i < CONV_ARRAY_LEN; i++) {
+      if (!conv_check(c->dtype, c->val[i % c->num], (char *) arr + i * size)) {
+        if (!nbad++) printf("  mismatch: %s array element %s\n",
+            conv_dtype_name[c->dtype], c->val[i % c->num]);
+      }
+    }
+  }
+
+  /* The input is restored for each conversion. */
+  size_t iter = 1, n;
+  double t;
+  for (;;) {
+    conv_perf_switch(perf, true);
+    t = conv_time();
+    for (n = 0; n < iter; n++) {
+      memcpy(buf, orig, len);
+      cfg_get_array(cfg, &par, 1);
+    }
+    t = conv_time() - t;
+    conv_perf_switch(perf, false);
+    if (t >= CONV_MIN_TIME) break;
+    iter <<= 1;
+  }
+
+  const double num = (double) iter * CONV_ARRAY_LEN;
+  printf("%-6s %-7s %-17s %9.2f", "array", conv_dtype_name[c->dtype],
+      c->label, t / num * 1e9);
+  conv_perf_print(perf, num);
+  printf("  %s\n", nbad ? "FAIL" : "ok");
+  free(orig);
+  free(buf);
+  return nbad;
+}
+
+int main(void) {
+  /* Arrays are allocated from the arena, which is reused by every run. */
+  cfg_t *cfg = cfg_init();
+  if (!cfg || cfg_use_arena(cfg)) {
+    fprintf(stderr, "Error: failed to initialise the configurations.\n");
+    return 1;
+  }
+  conv_perf_t perf;
+  conv_perf_init(&perf);
+
+  const int ncase = sizeof(conv_cases) / sizeof(conv_cases[0]);
+  printf("%-6s %-7s %-17s %9s %9s %9s %9s  %s\n", "kind", "dtype", "input",
+      "ns/elem", "cyc/elem", "ins/elem", "brm/elem", "check");
+  int nbad = 0;
+  for (int i = 0; i < ncase; i++) nbad += conv_scalar(conv_cases + i, &perf);
+  for (int i = 0; i < ncase; i++)
+    nbad += conv_array(conv_cases + i, cfg, &perf);
+
+#ifdef BENCH_ENABLE_PERF
+  for (int i = 0; i < CONV_NUM_COUNTER; i++)
+    if (perf.fd[i] != -1) close(perf.fd[i]);
+#endif
+  cfg_destroy(cfg);
+  return nbad ? 1 : 0;
+}
@@ -28,13 +28,99 @@
 
 *******************************************************************************/
 
+#if defined(CFG_ENABLE_POSIX) || defined(CFG_ENABLE_THREADS) || \
+  defined(CFG_ENABLE_INOTIFY) || defined(CFG_ENABLE_STATS)
+#define _POSIX_C_SOURCE 200809L
+#define CFG_POSIX_CLOCK         /* `clock_gettime` is available */
+#endif
+#ifdef CFG_ENABLE_POSIX
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef CFG_ENABLE_THREADS
+#include <pthread.h>
+#endif
+#ifdef CFG_ENABLE_INOTIFY
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
 #include <stdlib.h>
+#include <time.h>
 #include <limits.h>
 #include <stdint.h>
 #include <ctype.h>
 #include <string.h>
+#include <float.h>
+#include <math.h>
+#include <locale.h>
 #include "libcfg.h"
 
+/* SIMD instructions are used for scanning strings if they are available. */
+#if !defined(CFG_DISABLE_SIMD) && defined(__GNUC__) && defined(__SSE2__) && \
+  (defined(__x86_64__) || defined(__i386__))
+#define CFG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/* Groups of 8 digits are converted at once on little-endian machines. */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && \
+  __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CFG_SWAR_DIGITS
+#endif
+
+/* Statistics of parsing are collected only if they are requested at runtime,
+   and the counters compile to nothing without CFG_ENABLE_STATS. */
+#ifdef CFG_ENABLE_STATS
+#define CFG_STAT(cfg)           ((cfg_stats_t *) (cfg)->stats)
+#define CFG_STAT_ADD(cfg, x, n) \
+  do { if (CFG_STAT(cfg)) CFG_STAT(cfg)->x += (n); } while (0)
+#define CFG_STAT_START(cfg, t)  \
+  const double t = CFG_STAT(cfg) ? cfg_time() : 0
+#define CFG_STAT_STOP(cfg, x, t)        \
+  CFG_STAT_ADD(cfg, x, cfg_time() - (t))
+/* Conversions of values found by the tokenizer are excluded from its time. */
+#define CFG_STAT_TOKEN_START(cfg, t)    \
+  const double t = CFG_STAT(cfg) ? cfg_time() - CFG_STAT(cfg)->t_conv : 0
+#define CFG_STAT_TOKEN_STOP(cfg, t)     \
+  CFG_STAT_ADD(cfg, t_token, cfg_time() - CFG_STAT(cfg)->t_conv - (t))
+#else
+#define CFG_STAT_ADD(cfg, x, n)
+#define CFG_STAT_START(cfg, t)
+#define CFG_STAT_STOP(cfg, x, t)
+#define CFG_STAT_TOKEN_START(cfg, t)
+#define CFG_STAT_TOKEN_STOP(cfg, t)
+#endif
+
+/* Events are timed only if a tracing callback is registered. */
+#define CFG_TRACE_START(cfg, t) const double t = (cfg)->trace ? cfg_time() : 0
+#define CFG_TRACE(cfg, type, name, dtype, num, t) do {                  \
+    if ((cfg)->trace) cfg_trace(cfg, type, name, dtype, num, t, cfg_time()); \
+  } while (0)
+
+/* Snapshots are published with the atomic builtins of GCC compatible
+   compilers, or C11 atomics; the publisher is left out without them. */
+#if defined(__GNUC__)
+#define CFG_ATOMIC(type)        type
+#define CFG_ATOMIC_LOAD(p)      __atomic_load_n(p, __ATOMIC_SEQ_CST)
+#define CFG_ATOMIC_STORE(p, x)  __atomic_store_n(p, x, __ATOMIC_SEQ_CST)
+#define CFG_ATOMIC_CLEAR(p)     __atomic_store_n(p, 0, __ATOMIC_RELEASE)
+#define CFG_ATOMIC_SWAP(p, x)   __atomic_exchange_n(p, x, __ATOMIC_SEQ_CST)
+#define CFG_ATOMIC_INCR(p)      __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST)
+#elif defined(CFG_HAVE_PUBLISHER)
+#include <stdatomic.h>
+#define CFG_ATOMIC(type)        _Atomic(type)
+#define CFG_ATOMIC_LOAD(p)      atomic_load(p)
+#define CFG_ATOMIC_STORE(p, x)  atomic_store(p, x)
+#define CFG_ATOMIC_CLEAR(p)     \
+  atomic_store_explicit(p, 0, memory_order_release)
+#define CFG_ATOMIC_SWAP(p, x)   atomic_exchange(p, x)
+#define CFG_ATOMIC_INCR(p)      (atomic_fetch_add(p, 1) + 1)
+#endif
+
 /*============================================================================*\
                              Definitions of macros
 \*============================================================================*/
@@ -43,6 +129,77 @@
 #define CFG_STR_INIT_SIZE       1024      /* initial size of dynamic string */
 #define CFG_STR_MAX_DOUBLE_SIZE 134217728   /* maximum string doubling size */
 #define CFG_NUM_MAX_SIZE(type)  (CHAR_BIT * sizeof(type) / 3 + 2)
+#define CFG_ARRAY_INIT_SIZE     16      /* initial capacity of array values */
+
+/* Settings on the bulk conversion of numeric arrays. */
+#define CFG_CONV_BLOCK_SIZE     64      /* characters scanned at once */
+#define CFG_CONV_BULK_SIZE      48      /* look-ahead of the fast converter */
+#if INT_MAX >= 2147483647
+#define CFG_CONV_INT_DIGITS     9       /* digits that never overflow int */
+#else
+#define CFG_CONV_INT_DIGITS     4
+#endif
+#if LONG_MAX >= 9223372036854775807
+#define CFG_CONV_LONG_DIGITS    18      /* digits that never overflow long */
+#else
+#define CFG_CONV_LONG_DIGITS    9
+#endif
+
+/* Settings on converting arrays with threads (with CFG_ENABLE_THREADS). */
+#define CFG_THREAD_MIN_SIZE     1048576 /* minimum characters per thread */
+#define CFG_THREAD_TAIL_SIZE    4096    /* characters left to the caller */
+
+/* Settings on memory-mapped files (with CFG_ENABLE_POSIX). */
+#define CFG_MMAP_MIN_SIZE       1048576 /* minimum file size for mapping */
+
+/* Settings on the memory arena for retrieved values. */
+#define CFG_ARENA_BLOCK_SIZE    65536   /* default size of memory blocks */
+#define CFG_ARENA_ALIGN         16      /* alignment of allocated chunks */
+#define CFG_ARENA_ROUND(x)      \
+  (((x) + CFG_ARENA_ALIGN - 1) & ~((size_t) CFG_ARENA_ALIGN - 1))
+
+/* Settings on watching configuration files. */
+#define CFG_WATCH_BUF_SIZE      4096    /* size of the inotify event buffer */
+#define CFG_WATCH_PRESENT       1       /* entry in the previous load */
+#define CFG_WATCH_SEEN          2       /* entry in the current load */
+#define CFG_WATCH_OWNED         4       /* value set by the file */
+
+/* Settings on the snapshots for concurrent readers. */
+#define CFG_CACHE_LINE_SIZE     64      /* size of each reader slot */
+
+/* Settings on the binary cache of parsed configurations. */
+#define CFG_CACHE_MAGIC         "LIBCFGBC"      /* identifier of cache files */
+#define CFG_CACHE_VERSION       1       /* version of the cache format */
+#define CFG_CACHE_ORDER         0x01020304U     /* for checking byte order */
+#define CFG_CACHE_LAYOUT        ((uint32_t) (sizeof(bool) |             \
+    sizeof(int) << 4 | sizeof(long) << 8 | sizeof(float) << 12 |        \
+    sizeof(double) << 16 | sizeof(char) << 20))
+#define CFG_CACHE_CHUNK_SIZE    65536   /* size of chunks for reading files */
+#define CFG_CACHE_ALIGN         8       /* alignment of records */
+#define CFG_CACHE_ROUND(x)      \
+  (((x) + CFG_CACHE_ALIGN - 1) & ~((uint64_t) CFG_CACHE_ALIGN - 1))
+#define CFG_HASH64_OFFSET       14695981039346656037ULL /* 64-bit FNV offset */
+#define CFG_HASH64_PRIME        1099511628211ULL        /* 64-bit FNV prime */
+
+/* Settings on sharing parsed configurations (with CFG_ENABLE_POSIX). */
+#define CFG_SHARED_PREFIX       "/libcfg-"      /* names of the segments */
+#define CFG_SHARED_NAME_LEN     32      /* maximum length of the names */
+#define CFG_SHARED_MAX_WAIT     1000    /* attempts to attach to segments */
+#define CFG_SHARED_WAIT_NSEC    1000000 /* interval between the attempts */
+
+/* Settings on the hash tables for indexing parameters. */
+#define CFG_HASH_INIT_SIZE      64      /* initial number of hash slots */
+#define CFG_HASH_EMPTY          (-1)    /* index of unoccupied hash slots */
+#define CFG_HASH_OFFSET         2166136261U     /* 32-bit FNV-1a offset basis */
+#define CFG_HASH_PRIME          16777619U       /* 32-bit FNV-1a prime */
+
+/* Indices of command line functions are stored as negative numbers. */
+#define CFG_INDEX_OF_FUNC(x)    (-2 - (x))
+#define CFG_INDEX_IS_FUNC(x)    ((x) < CFG_HASH_EMPTY)
+#define CFG_FUNC_OF_INDEX(x)    (-2 - (x))
+
+/* Data type of the elements of arrays. */
+#define CFG_DTYPE_OF_ARRAY(x)   ((x) - CFG_ARRAY_BOOL + CFG_DTYPE_BOOL)
 
 /* Settings on the source of the configurations. */
 #define CFG_SRC_NULL            0
@@ -64,6 +221,35 @@
 #define CFG_ERRNO(cfg)          (((cfg_error_t *)cfg->error)->errno)
 #define CFG_IS_ERROR(cfg)       (CFG_ERRNO(cfg) != 0)
 
+/* Locale-independent character classification. */
+#define CFG_IS_SPACE(c)         ((c) == ' ' || ((c) >= '\t' && (c) <= '\r'))
+#define CFG_IS_DIGIT(c)         ((c) >= '0' && (c) <= '9')
+#define CFG_IS_ALPHA(c)         (((c) | 0x20) >= 'a' && ((c) | 0x20) <= 'z')
+#define CFG_IS_ALNUM(c)         (CFG_IS_ALPHA(c) || CFG_IS_DIGIT(c))
+#define CFG_IS_PRINT(c)         ((c) >= ' ' && (c) <= '~')
+#define CFG_IS_XDIGIT(c)        (CFG_IS_DIGIT(c) ||                     \
+    (((c) | 0x20) >= 'a' && ((c) | 0x20) <= 'f'))
+
+/* Character class for the string parser, resolved at compile time. */
+#define CFG_CHAR_CLASS(c) (                                             \
+  (c) == CFG_SYM_EQUAL ? CFG_CHAR_EQUAL :                               \
+  (c) == CFG_SYM_ARRAY_START ? CFG_CHAR_ARRAY_START :                   \
+  (c) == CFG_SYM_ARRAY_SEP ? CFG_CHAR_ARRAY_SEP :                       \
+  (c) == CFG_SYM_ARRAY_END ? CFG_CHAR_ARRAY_END :                       \
+  (c) == CFG_SYM_COMMENT ? CFG_CHAR_COMMENT :                           \
+  (c) == CFG_SYM_NEWLINE ? CFG_CHAR_NEWLINE :                           \
+  (c) == '"' ? CFG_CHAR_DQUOTE : (c) == '\'' ? CFG_CHAR_SQUOTE :        \
+  (c) == ' ' ? CFG_CHAR_BLANK : CFG_IS_SPACE(c) ? CFG_CHAR_SPACE :      \
+  (CFG_IS_ALPHA(c) || (c) == '_') ? CFG_CHAR_ALPHA :                    \
+  CFG_IS_DIGIT(c) ? CFG_CHAR_DIGIT :                                    \
+  CFG_IS_PRINT(c) ? CFG_CHAR_GRAPH : CFG_CHAR_OTHER)
+#define CFG_CHAR_CLASS4(c)      CFG_CHAR_CLASS(c), CFG_CHAR_CLASS(c + 1), \
+  CFG_CHAR_CLASS(c + 2), CFG_CHAR_CLASS(c + 3)
+#define CFG_CHAR_CLASS16(c)     CFG_CHAR_CLASS4(c), CFG_CHAR_CLASS4(c + 4), \
+  CFG_CHAR_CLASS4(c + 8), CFG_CHAR_CLASS4(c + 12)
+#define CFG_CHAR_CLASS64(c)     CFG_CHAR_CLASS16(c), CFG_CHAR_CLASS16(c + 16), \
+  CFG_CHAR_CLASS16(c + 32), CFG_CHAR_CLASS16(c + 48)
+
 /* Check if a string is a valid command line option, or parser termination. */
 #define CFG_IS_OPT(a) (                                                 \
   a[0] == CFG_CMD_FLAG && a[1] &&                                       \
@@ -90,6 +276,8 @@ typedef struct {
   char *lopt;                   /* long command line option                 */
   char *value;                  /* value of the parameter                   */
   void *var;                    /* variable for saving the retrieved value  */
+  void *mem;                    /* memory from the arena for the value      */
+  size_t msize;                 /* size of the memory from the arena        */
 } cfg_param_valid_t;
 
 /* Data structure for storing verified command line functions. */
@@ -111,17 +299,171 @@ typedef struct {
   size_t max;                   /* allocated space for the messages         */
 } cfg_error_t;
 
+/* Slot of the open addressing hash tables. */
+typedef struct {
+  uint32_t hash;                /* cached hash value of the key             */
+  int idx;                      /* index of the entry, or CFG_HASH_EMPTY    */
+} cfg_hash_slot_t;
+
+/* Open addressing hash table with linear probing. */
+typedef struct {
+  size_t cap;                   /* number of slots, must be a power of 2    */
+  size_t num;                   /* number of occupied slots                 */
+  cfg_hash_slot_t *slot;        /* the slots of the hash table              */
+} cfg_hash_t;
+
+/* Data structure for indexing the registered parameters and functions. */
+typedef struct {
+  size_t pcap;                  /* allocated number of parameters           */
+  size_t fcap;                  /* allocated number of functions            */
+  int opt[UCHAR_MAX + 1];       /* direct lookup table for short options    */
+  cfg_hash_t name;              /* hash table for parameter names           */
+  cfg_hash_t lopt;              /* hash table for long options              */
+  cfg_hash_t func;              /* hash table for function and arguments    */
+  cfg_hash_t var;               /* hash table for variable addresses        */
+} cfg_index_t;
+
+/* Memory block of the arena, followed by the memory for values. */
+typedef struct cfg_arena_block_struct {
+  struct cfg_arena_block_struct *next;  /* previously allocated block     */
+  size_t size;                  /* capacity of the block                    */
+  size_t used;                  /* number of bytes in use                   */
+} cfg_arena_block_t;
+
+/* Chunk of memory released to the arena, for being reused later. */
+typedef struct cfg_arena_chunk_struct {
+  struct cfg_arena_chunk_struct *next;  /* next released chunk            */
+  size_t size;                  /* size of the chunk                        */
+} cfg_arena_chunk_t;
+
+/* Memory arena for values of strings and arrays. */
+typedef struct {
+  cfg_arena_block_t *block;     /* blocks, the most recent one first        */
+  cfg_arena_chunk_t *free;      /* list of released chunks                  */
+} cfg_arena_t;
+
+/* Buffer of configuration text retained for string values. */
+typedef struct cfg_source_buf_struct {
+  struct cfg_source_buf_struct *next;   /* previously retained buffer     */
+  void *addr;                   /* address of the buffer                    */
+  size_t size;                  /* size of the mapping; 0 if allocated      */
+} cfg_source_buf_t;
+
+/* Configuration text retained for string values. */
+typedef struct {
+  cfg_source_buf_t *buf;        /* buffers, the most recent one first       */
+} cfg_source_t;
+
+/* Callback for tracing the parsing. */
+typedef struct {
+  cfg_trace_func_t func;        /* the callback function                    */
+  void *ctx;                    /* context passed to the callback           */
+} cfg_trace_t;
+
+#ifdef CFG_ENABLE_THREADS
+/* Piece of a numerical array converted by a thread. */
+typedef struct {
+  const char *str;              /* starting point of the piece              */
+  size_t len;                   /* number of characters readable from `str` */
+  size_t end;                   /* number of characters of the piece        */
+  cfg_dtype_t dtype;            /* data type of the elements                */
+  size_t size;                  /* size of each element                     */
+  void *var;                    /* address for the converted values         */
+  size_t num;                   /* number of elements in the piece          */
+  bool ok;                      /* true if all the elements are converted   */
+} cfg_array_piece_t;
+#endif
+
+/* Value of a parameter in a snapshot. */
+typedef struct {
+  cfg_dtype_t dtype;            /* data type of the parameter               */
+  int src;                      /* source of the value                      */
+  int narr;                     /* number of elements; 0 if not set         */
+  size_t nlen;                  /* length of the parameter name             */
+  char *name;                   /* name of the parameter                    */
+  void *value;                  /* the value or the array elements          */
+} cfg_snapshot_par_t;
+
+/* Immutable copy of the parameter values, allocated as a single block. */
+struct cfg_snapshot_struct {
+  int npar;                     /* number of parameters                     */
+  size_t epoch;                 /* epoch at which the snapshot is retired   */
+  cfg_snapshot_t *next;         /* next retired snapshot                    */
+  cfg_hash_t name;              /* hash table for parameter names           */
+  cfg_snapshot_par_t *par;      /* the parameters                           */
+  cfg_allocator_t alloc;        /* copy of the allocation functions, if any */
+};
+
+#ifdef CFG_HAVE_PUBLISHER
+/* Epoch of a reader, padded to avoid sharing cache lines among readers. */
+typedef struct {
+  CFG_ATOMIC(size_t) epoch;     /* epoch seen by the reader; 0 if inactive  */
+  char pad[CFG_CACHE_LINE_SIZE - sizeof(CFG_ATOMIC(size_t))];
+} cfg_reader_slot_t;
+
+/* Publisher of snapshots for concurrent readers. */
+struct cfg_publisher_struct {
+  CFG_ATOMIC(cfg_snapshot_t *) snap;    /* the current snapshot             */
+  CFG_ATOMIC(size_t) epoch;     /* the current epoch                        */
+  cfg_snapshot_t *retired;      /* snapshots waiting to be released         */
+  int nreader;                  /* number of reader slots                   */
+  cfg_reader_slot_t *slot;      /* epochs of the readers                    */
+};
+#endif
+
 /* String parser states. */
 typedef enum {
   CFG_PARSE_START,              CFG_PARSE_KEYWORD,      CFG_PARSE_EQUAL,
   CFG_PARSE_VALUE_START,        CFG_PARSE_VALUE,
-  CFG_PARSE_QUOTE,              CFG_PARSE_QUOTE_END,
+  CFG_PARSE_DQUOTE,             CFG_PARSE_SQUOTE,       CFG_PARSE_QUOTE_END,
   CFG_PARSE_ARRAY_START,        CFG_PARSE_ARRAY_VALUE,
-  CFG_PARSE_ARRAY_QUOTE,        CFG_PARSE_ARRAY_QUOTE_END,
-  CFG_PARSE_ARRAY_NEWLINE,      CFG_PARSE_CLEAN,
-  CFG_PARSE_ARRAY_END,          CFG_PARSE_ARRAY_DONE
+  CFG_PARSE_ARRAY_DQUOTE,       CFG_PARSE_ARRAY_SQUOTE,
+  CFG_PARSE_ARRAY_QUOTE_END,    CFG_PARSE_ARRAY_NEWLINE,
+  CFG_PARSE_CLEAN,              CFG_PARSE_ARRAY_END,
+  CFG_PARSE_ARRAY_NUMBER_END,
+  CFG_PARSE_NUM_STATES
 } cfg_parse_state_t;
 
+/* Character classes for the string parser. */
+typedef enum {
+  CFG_CHAR_OTHER,               /* not printable                            */
+  CFG_CHAR_BLANK,               /* ' '                                      */
+  CFG_CHAR_SPACE,               /* whitespaces other than ' '               */
+  CFG_CHAR_ALPHA,               /* letters and '_'                          */
+  CFG_CHAR_DIGIT,               /* decimal digits                           */
+  CFG_CHAR_EQUAL,               /* CFG_SYM_EQUAL                            */
+  CFG_CHAR_DQUOTE,              /* '"'                                      */
+  CFG_CHAR_SQUOTE,              /* '\''                                     */
+  CFG_CHAR_ARRAY_START,         /* CFG_SYM_ARRAY_START                      */
+  CFG_CHAR_ARRAY_SEP,           /* CFG_SYM_ARRAY_SEP                        */
+  CFG_CHAR_ARRAY_END,           /* CFG_SYM_ARRAY_END                        */
+  CFG_CHAR_COMMENT,             /* CFG_SYM_COMMENT                          */
+  CFG_CHAR_NEWLINE,             /* CFG_SYM_NEWLINE                          */
+  CFG_CHAR_GRAPH,               /* other printable characters               */
+  CFG_CHAR_NUM_CLASSES
+} cfg_char_class_t;
+
+/* Actions associated with the string parser state transitions. */
+typedef enum {
+  CFG_ACT_ERROR,                /* invalid character, must be 0             */
+  CFG_ACT_NONE,                 /* nothing to be done                       */
+  CFG_ACT_KEY,                  /* beginning of the keyword                 */
+  CFG_ACT_KEY_END,              /* end of the keyword                       */
+  CFG_ACT_VALUE,                /* beginning of the value                   */
+  CFG_ACT_NEWLINE,              /* possible line continuation               */
+  CFG_ACT_CLEAN,                /* comment after line continuation          */
+  CFG_ACT_SEP,                  /* separator of array elements              */
+  CFG_ACT_END,                  /* end of array                             */
+  CFG_ACT_DONE,                 /* comment after the value                  */
+  CFG_ACT_PASS                  /* comment without value                    */
+} cfg_parse_action_t;
+
+/* State transition of the string parser. */
+typedef struct {
+  unsigned char state;          /* the next state                           */
+  unsigned char action;         /* action to be taken                       */
+} cfg_parse_trans_t;
+
 /* Return value for the parser status. */
 typedef enum {
   CFG_PARSE_DONE,
@@ -130,6 +472,128 @@ typedef enum {
   CFG_PARSE_ERROR
 } cfg_parse_return_t;
 
+/* Entry of a configuration file that is tokenized in advance. */
+typedef struct {
+  cfg_parse_return_t status;    /* status of the line parser                */
+  size_t nline;                 /* line number of the end of the entry      */
+  char *key;                    /* keyword of the entry                     */
+  char *value;                  /* value of the entry                       */
+} cfg_entry_t;
+
+/* Configuration file that is read and tokenized in advance. */
+typedef struct {
+  const char *fname;            /* name of the file                         */
+  char *buf;                    /* content of the file                      */
+  size_t len;                   /* length of the content                    */
+  cfg_entry_t *entry;           /* entries in the order of appearance       */
+  size_t num;                   /* number of entries                        */
+  size_t cap;                   /* capacity of the entries                  */
+  int err;                      /* error occurred when reading the file     */
+  const char *msg;              /* message for the error                    */
+  const cfg_allocator_t *alloc; /* functions for memory allocation          */
+  bool timed;                   /* true for statistics or tracing           */
+  double time[4];               /* times of opening, reading, and splitting */
+#ifdef CFG_ENABLE_STATS
+  size_t nline;                 /* number of lines                          */
+  size_t ncont;                 /* number of continuation lines             */
+#endif
+} cfg_file_t;
+
+#ifdef CFG_ENABLE_THREADS
+/* Configuration files loaded by a thread. */
+typedef struct {
+  cfg_file_t *file;             /* the first file for this thread           */
+  int num;                      /* number of files from `file`              */
+  int step;                     /* stride of the files for this thread      */
+} cfg_file_task_t;
+#endif
+
+/* State of a parameter in a watched file. */
+typedef struct {
+  int flag;                     /* CFG_WATCH_* flags of the entry           */
+  uint32_t hash;                /* hash value of the entry value            */
+  size_t vlen;                  /* length of the entry value                */
+} cfg_watch_entry_t;
+
+/* Configuration file watched for changes. */
+typedef struct {
+  char *fname;                  /* name of the file                         */
+  const char *base;             /* name of the file without the directory   */
+  int prior;                    /* priority of values read from the file    */
+  int wd;                       /* inotify watch descriptor                 */
+  bool dirty;                   /* true if the file is modified             */
+  uint32_t hash;                /* hash value of the content                */
+  size_t len;                   /* length of the content                    */
+  int npar;                     /* number of parameters with states         */
+  cfg_watch_entry_t *entry;     /* states of the parameters in the file     */
+} cfg_watch_file_t;
+
+/* Data structure for the watched configuration files. */
+typedef struct {
+  int fd;                       /* inotify file descriptor                  */
+  size_t num;                   /* number of watched files                  */
+  size_t cap;                   /* allocated number of watched files        */
+  cfg_watch_file_t *file;       /* the watched files                        */
+  size_t nvar;                  /* number of updated variables              */
+  size_t vcap;                  /* allocated number of updated variables    */
+  const void **var;             /* addresses of the updated variables       */
+} cfg_watch_t;
+
+/* Header of the binary cache file. */
+typedef struct {
+  char magic[8];                /* CFG_CACHE_MAGIC, without termination     */
+  uint32_t version;             /* CFG_CACHE_VERSION                        */
+  uint32_t order;               /* CFG_CACHE_ORDER in the native byte order */
+  uint32_t layout;              /* CFG_CACHE_LAYOUT                         */
+  uint32_t nfile;               /* number of source file records            */
+  uint32_t npar;                /* number of parameter records              */
+  uint32_t pad;                 /* padding for the alignment                */
+  uint64_t size;                /* number of bytes following the header     */
+  uint64_t hash;                /* hash value of the bytes after the header */
+} cfg_cache_head_t;
+
+/* Record of a source file in the cache, followed by the filename. */
+typedef struct {
+  uint64_t size;                /* size of the file                         */
+  int64_t sec;                  /* modification time, in seconds            */
+  int64_t nsec;                 /* nanoseconds of the modification time     */
+  uint64_t hash;                /* hash value of the content                */
+  uint64_t nlen;                /* length of the filename, with '\0'        */
+} cfg_cache_file_t;
+
+/* Record of a parameter in the cache, followed by the name and the value. */
+typedef struct {
+  int32_t dtype;                /* data type of the parameter               */
+  int32_t src;                  /* priority of the value                    */
+  uint64_t nlen;                /* length of the name, with '\0'            */
+  uint64_t narr;                /* number of elements                       */
+  uint64_t size;                /* number of bytes of the value             */
+} cfg_cache_par_t;
+
+/* Private variable for parsing values into the shared memory. */
+typedef union {
+  bool b;
+  char c;
+  int i;
+  long l;
+  float f;
+  double d;
+  void *p;
+} cfg_shared_var_t;
+
+/* Data structure for the state of the configuration reader. */
+typedef struct {
+  int prior;                    /* priority of the values                   */
+  size_t nline;                 /* number of lines processed                */
+  cfg_parse_state_t state;      /* state of the line parser                 */
+  char *key;                    /* keyword of the entry being parsed        */
+  char *value;                  /* value of the entry being parsed          */
+  char *buf;                    /* buffer for copies of the unparsed lines  */
+  size_t pos;                   /* starting position of the unparsed line   */
+  size_t len;                   /* length of the buffered characters        */
+  size_t cap;                   /* allocated space for the buffer           */
+} cfg_reader_t;
+
 
 /*============================================================================*\
                        Functions for string manipulation
@@ -149,6 +613,502 @@ static inline size_t cfg_strnlen(const char *src, const size_t max) {
   return 0;
 }
 
+/******************************************************************************
+Function `cfg_hash_str`:
+  Compute the 32-bit FNV-1a hash value of a null terminated string.
+Arguments:
+  * `src`:      the input string;
+  * `len`:      address for the length of the string, including the '\0'.
+Return:
+  The hash value of the string.
+******************************************************************************/
+static inline uint32_t cfg_hash_str(const char *src, size_t *len) {
+  uint32_t hash = CFG_HASH_OFFSET;
+  const char *p = src;
+  while (*p) {
+    hash ^= (unsigned char) *p++;
+    hash *= CFG_HASH_PRIME;
+  }
+  *len = p - src + 1;
+  return hash;
+}
+
+/******************************************************************************
+Function `cfg_hash_mem`:
+  Continue computing the 32-bit FNV-1a hash value with a block of memory.
+Arguments:
+  * `hash`:     hash value of the preceding data, or CFG_HASH_OFFSET;
+  * `src`:      the memory block;
+  * `size`:     size of the memory block.
+Return:
+  The hash value of the data.
+******************************************************************************/
+static inline uint32_t cfg_hash_mem(uint32_t hash, const void *src,
+    const size_t size) {
+  const unsigned char *p = (const unsigned char *) src;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= p[i];
+    hash *= CFG_HASH_PRIME;
+  }
+  return hash;
+}
+
+/******************************************************************************
+Function `cfg_grow_size`:
+  Compute the new capacity of a dynamic array, by doubling the current one.
+Arguments:
+  * `cap`:      the current capacity;
+  * `num`:      the minimum number of elements required;
+  * `size`:     size of each element.
+Return:
+  The new capacity on success; 0 on overflow.
+******************************************************************************/
+static inline size_t cfg_grow_size(size_t cap, const size_t num,
+    const size_t size) {
+  if (!cap) cap = 1;
+  while (cap < num) {
+    if (cap > SIZE_MAX / 2) return 0;
+    cap <<= 1;
+  }
+  if (cap > SIZE_MAX / size) return 0;
+  return cap;
+}
+
+/******************************************************************************
+Function `cfg_dtype_size`:
+  Return the size of a scalar data type.
+Arguments:
+  * `dtype`:    the data type.
+Return:
+  Size of the data type on success; 0 for invalid data types.
+******************************************************************************/
+static inline size_t cfg_dtype_size(const cfg_dtype_t dtype) {
+  switch (dtype) {
+    case CFG_DTYPE_BOOL:        return sizeof(bool);
+    case CFG_DTYPE_CHAR:        return sizeof(char);
+    case CFG_DTYPE_INT:         return sizeof(int);
+    case CFG_DTYPE_LONG:        return sizeof(long);
+    case CFG_DTYPE_FLT:         return sizeof(float);
+    case CFG_DTYPE_DBL:         return sizeof(double);
+    case CFG_DTYPE_STR:         return sizeof(char *);
+    default:                    return 0;
+  }
+}
+
+/******************************************************************************
+Function `cfg_time`:
+  Read the monotonic clock for statistics and tracing, or the processor time
+  if POSIX functions are not enabled.
+Return:
+  The current time in seconds.
+******************************************************************************/
+static inline double cfg_time(void) {
+#ifdef CFG_POSIX_CLOCK
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+  return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/******************************************************************************
+Function `cfg_malloc`:
+  Allocate memory with the functions supplied by the user, or `malloc`.
+Arguments:
+  * `alloc`:    the allocation functions, or NULL for the standard ones;
+  * `size`:     number of bytes to be allocated.
+Return:
+  Address of the allocated memory on success; NULL on error.
+******************************************************************************/
+static inline void *cfg_malloc(const cfg_allocator_t *alloc,
+    const size_t size) {
+  return alloc ? alloc->malloc(size, alloc->ctx) : malloc(size);
+}
+
+/******************************************************************************
+Function `cfg_calloc`:
+  Allocate zero-initialised memory with the functions supplied by the user,
+  or `calloc`.
+Arguments:
+  * `alloc`:    the allocation functions, or NULL for the standard ones;
+  * `num`:      number of elements;
+  * `size`:     size of each element.
+Return:
+  Address of the allocated memory on success; NULL on error.
+******************************************************************************/
+static inline void *cfg_calloc(const cfg_allocator_t *alloc,
+    const size_t num, const size_t size) {
+  if (!alloc) return calloc(num, size);
+  if (size && num > SIZE_MAX / size) return NULL;
+  void *ptr = alloc->malloc(num * size, alloc->ctx);
+  return ptr ? memset(ptr, 0, num * size) : NULL;
+}
+
+/******************************************************************************
+Function `cfg_realloc`:
+  Reallocate memory with the functions supplied by the user, or `realloc`.
+  The user-supplied `realloc` is never called with a NULL pointer.
+Arguments:
+  * `alloc`:    the allocation functions, or NULL for the standard ones;
+  * `ptr`:      address of the memory to be reallocated;
+  * `size`:     the new number of bytes.
+Return:
+  Address of the reallocated memory on success; NULL on error.
+******************************************************************************/
+static inline void *cfg_realloc(const cfg_allocator_t *alloc, void *ptr,
+    const size_t size) {
+  if (!alloc) return realloc(ptr, size);
+  return ptr ? alloc->realloc(ptr, size, alloc->ctx) :
+    alloc->malloc(size, alloc->ctx);
+}
+
+/******************************************************************************
+Function `cfg_free`:
+  Release memory with the functions supplied by the user, or `free`.
+  The user-supplied `free` is never called with a NULL pointer.
+Arguments:
+  * `alloc`:    the allocation functions, or NULL for the standard ones;
+  * `ptr`:      address of the memory to be released.
+******************************************************************************/
+static inline void cfg_free(const cfg_allocator_t *alloc, void *ptr) {
+  if (!alloc) free(ptr);
+  else if (ptr) alloc->free(ptr, alloc->ctx);
+}
+
+
+/*============================================================================*\
+               Functions for scanning strings with SIMD instructions
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_scan_special_scalar`:
+  Find the first character that is either one of the given symbols, or not
+  printable, by checking the characters one by one.
+Arguments:
+  * `src`:      the input string;
+  * `len`:      number of characters to be checked;
+  * `c1`:       the first symbol to be searched for;
+  * `c2`:       the second symbol to be searched for;
+  * `c3`:       the third symbol to be searched for.
+Return:
+  Index of the first special character; `len` if it is not found.
+******************************************************************************/
+static size_t cfg_scan_special_scalar(const char *src, const size_t len,
+    const char c1, const char c2, const char c3) {
+  for (size_t i = 0; i < len; i++) {
+    const char c = src[i];
+    if (c == c1 || c == c2 || c == c3 || !CFG_IS_PRINT(c)) return i;
+  }
+  return len;
+}
+
+#ifdef CFG_SIMD_X86
+/******************************************************************************
+Function `cfg_scan_special_sse2`:
+  Find the first special character, by classifying 16 characters at once.
+Arguments:
+  See `cfg_scan_special_scalar`.
+Return:
+  Index of the first special character; `len` if it is not found.
+******************************************************************************/
+static size_t cfg_scan_special_sse2(const char *src, const size_t len,
+    const char c1, const char c2, const char c3) {
+  const __m128i v1 = _mm_set1_epi8(c1);
+  const __m128i v2 = _mm_set1_epi8(c2);
+  const __m128i v3 = _mm_set1_epi8(c3);
+  /* Printable characters are within (0x1F, 0x7F) as signed bytes. */
+  const __m128i lo = _mm_set1_epi8(0x1F);
+  const __m128i hi = _mm_set1_epi8(0x7F);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+    const __m128i print = _mm_and_si128(_mm_cmpgt_epi8(v, lo),
+        _mm_cmplt_epi8(v, hi));
+    const __m128i sym = _mm_or_si128(_mm_cmpeq_epi8(v, v1),
+        _mm_or_si128(_mm_cmpeq_epi8(v, v2), _mm_cmpeq_epi8(v, v3)));
+    const int mask = _mm_movemask_epi8(_mm_andnot_si128(print,
+        _mm_set1_epi8(-1))) | _mm_movemask_epi8(sym);
+    if (mask) return i + __builtin_ctz(mask);
+  }
+  return i + cfg_scan_special_scalar(src + i, len - i, c1, c2, c3);
+}
+
+/******************************************************************************
+Function `cfg_scan_special_avx2`:
+  Find the first special character, by classifying 32 characters at once.
+Arguments:
+  See `cfg_scan_special_scalar`.
+Return:
+  Index of the first special character; `len` if it is not found.
+******************************************************************************/
+__attribute__((target("avx2")))
+static size_t cfg_scan_special_avx2(const char *src, const size_t len,
+    const char c1, const char c2, const char c3) {
+  const __m256i v1 = _mm256_set1_epi8(c1);
+  const __m256i v2 = _mm256_set1_epi8(c2);
+  const __m256i v3 = _mm256_set1_epi8(c3);
+  const __m256i lo = _mm256_set1_epi8(0x1F);
+  const __m256i hi = _mm256_set1_epi8(0x7F);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    const __m256i v = _mm256_loadu_si256((const __m256i *) (src + i));
+    const __m256i print = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo),
+        _mm256_cmpgt_epi8(hi, v));
+    const __m256i sym = _mm256_or_si256(_mm256_cmpeq_epi8(v, v1),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, v2), _mm256_cmpeq_epi8(v, v3)));
+    const unsigned mask = ~(unsigned) _mm256_movemask_epi8(print) |
+        (unsigned) _mm256_movemask_epi8(sym);
+    if (mask) return i + __builtin_ctz(mask);
+  }
+  return i + cfg_scan_special_sse2(src + i, len - i, c1, c2, c3);
+}
+#endif
+
+/* Implementation of the scanner, chosen at load time by `cfg_scan_init`. */
+static size_t (*cfg_scan_special)(const char *, const size_t, const char,
+    const char, const char) = cfg_scan_special_scalar;
+
+#ifdef CFG_SIMD_X86
+/******************************************************************************
+Function `cfg_scan_init`:
+  Choose the fastest implementation of the scanner supported by the CPU.
+  It runs once when the program or library is loaded, so the choice is never
+  written while other threads are parsing.
+******************************************************************************/
+__attribute__((constructor))
+static void cfg_scan_init(void) {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) cfg_scan_special = cfg_scan_special_avx2;
+  else cfg_scan_special = cfg_scan_special_sse2;
+}
+#endif
+
+
+/*============================================================================*\
+                    Functions for indexing with hash tables
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_hash_resize`:
+  Reallocate the slots of a hash table and re-insert all the entries.
+Arguments:
+  * `tab`:      the hash table;
+  * `cap`:      the new number of slots, must be a power of 2;
+  * `alloc`:    the allocation functions.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_hash_resize(cfg_hash_t *tab, const size_t cap,
+    const cfg_allocator_t *alloc) {
+  cfg_hash_slot_t *slot = cfg_malloc(alloc, cap * sizeof *slot);
+  if (!slot) return CFG_ERR_MEMORY;
+  for (size_t i = 0; i < cap; i++) slot[i].idx = CFG_HASH_EMPTY;
+
+  /* The cached hash values are used for re-inserting the entries. */
+  for (size_t i = 0; i < tab->cap; i++) {
+    if (tab->slot[i].idx == CFG_HASH_EMPTY) continue;
+    size_t j = tab->slot[i].hash & (cap - 1);
+    while (slot[j].idx != CFG_HASH_EMPTY) j = (j + 1) & (cap - 1);
+    slot[j] = tab->slot[i];
+  }
+
+  if (tab->slot) cfg_free(alloc, tab->slot);
+  tab->slot = slot;
+  tab->cap = cap;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_hash_insert`:
+  Insert an entry into a hash table, without checking duplicates.
+Arguments:
+  * `tab`:      the hash table;
+  * `hash`:     hash value of the key;
+  * `idx`:      index of the entry;
+  * `alloc`:    the allocation functions.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_hash_insert(cfg_hash_t *tab, const uint32_t hash,
+    const int idx, const cfg_allocator_t *alloc) {
+  /* Keep the load factor below 0.5. */
+  if ((tab->num + 1) << 1 > tab->cap) {
+    size_t cap = tab->cap ? tab->cap : CFG_HASH_INIT_SIZE;
+    while ((tab->num + 1) << 1 > cap) {
+      if (cap > SIZE_MAX / 2 / sizeof(cfg_hash_slot_t)) return CFG_ERR_MEMORY;
+      cap <<= 1;
+    }
+    if (cap != tab->cap && cfg_hash_resize(tab, cap, alloc))
+      return CFG_ERR_MEMORY;
+  }
+
+  size_t i = hash & (tab->cap - 1);
+  while (tab->slot[i].idx != CFG_HASH_EMPTY) i = (i + 1) & (tab->cap - 1);
+  tab->slot[i].hash = hash;
+  tab->slot[i].idx = idx;
+  tab->num += 1;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_find_name`:
+  Search for a registered parameter given the name.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `name`:     the null terminated name of the parameter.
+Return:
+  Index of the parameter on success; CFG_HASH_EMPTY if it is not found.
+******************************************************************************/
+static int cfg_find_name(const cfg_t *cfg, const char *name) {
+  const cfg_hash_t *tab = &((cfg_index_t *) cfg->index)->name;
+  if (!tab->num) return CFG_HASH_EMPTY;
+  const cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  size_t len;
+  const uint32_t hash = cfg_hash_str(name, &len);
+
+  size_t i = hash & (tab->cap - 1);
+  while (tab->slot[i].idx != CFG_HASH_EMPTY) {
+    const int j = tab->slot[i].idx;
+    CFG_STAT_ADD(cfg, nprobe, 1);
+    if (tab->slot[i].hash == hash && params[j].nlen == len &&
+        !memcmp(params[j].name, name, len)) return j;
+    i = (i + 1) & (tab->cap - 1);
+  }
+  CFG_STAT_ADD(cfg, nprobe, 1);
+  return CFG_HASH_EMPTY;
+}
+
+/******************************************************************************
+Function `cfg_find_lopt`:
+  Search for a registered parameter or function given the long option.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `lopt`:     the null terminated long command line option.
+Return:
+  Index of the parameter, or CFG_INDEX_OF_FUNC of the function index on
+  success; CFG_HASH_EMPTY if the long option is not found.
+******************************************************************************/
+static int cfg_find_lopt(const cfg_t *cfg, const char *lopt) {
+  const cfg_hash_t *tab = &((cfg_index_t *) cfg->index)->lopt;
+  if (!tab->num) return CFG_HASH_EMPTY;
+  const cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  const cfg_func_valid_t *funcs = (cfg_func_valid_t *) cfg->funcs;
+  size_t len;
+  const uint32_t hash = cfg_hash_str(lopt, &len);
+
+  size_t i = hash & (tab->cap - 1);
+  while (tab->slot[i].idx != CFG_HASH_EMPTY) {
+    CFG_STAT_ADD(cfg, nprobe, 1);
+    if (tab->slot[i].hash == hash) {
+      const int j = tab->slot[i].idx;
+      const char *str;
+      size_t llen;
+      if (CFG_INDEX_IS_FUNC(j)) {
+        str = funcs[CFG_FUNC_OF_INDEX(j)].lopt;
+        llen = funcs[CFG_FUNC_OF_INDEX(j)].llen;
+      }
+      else {
+        str = params[j].lopt;
+        llen = params[j].llen;
+      }
+      if (llen == len && !memcmp(str, lopt, len)) return j;
+    }
+    i = (i + 1) & (tab->cap - 1);
+  }
+  CFG_STAT_ADD(cfg, nprobe, 1);
+  return CFG_HASH_EMPTY;
+}
+
+/******************************************************************************
+Function `cfg_find_var`:
+  Search for a registered parameter given the address of the variable.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `var`:      address of the variable.
+Return:
+  Index of the first parameter registered with this variable on success;
+  CFG_HASH_EMPTY if the variable is not found.
+******************************************************************************/
+static int cfg_find_var(const cfg_t *cfg, const void *var) {
+  const cfg_hash_t *tab = &((cfg_index_t *) cfg->index)->var;
+  if (!tab->num) return CFG_HASH_EMPTY;
+  const cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  const uint32_t hash = cfg_hash_mem(CFG_HASH_OFFSET, &var, sizeof var);
+
+  size_t i = hash & (tab->cap - 1);
+  while (tab->slot[i].idx != CFG_HASH_EMPTY) {
+    const int j = tab->slot[i].idx;
+    if (tab->slot[i].hash == hash && params[j].var == var) return j;
+    i = (i + 1) & (tab->cap - 1);
+  }
+  return CFG_HASH_EMPTY;
+}
+
+/******************************************************************************
+Function `cfg_hash_func`:
+  Compute the hash value of a command line function with its arguments.
+Arguments:
+  * `fun`:      the verified command line function.
+Return:
+  The hash value of the function pointer and argument address.
+******************************************************************************/
+static inline uint32_t cfg_hash_func(const cfg_func_valid_t *fun) {
+  uint32_t hash = cfg_hash_mem(CFG_HASH_OFFSET, &fun->func, sizeof fun->func);
+  return cfg_hash_mem(hash, &fun->args, sizeof fun->args);
+}
+
+/******************************************************************************
+Function `cfg_find_func`:
+  Search for a registered command line function with the same arguments.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fun`:      the command line function to be searched for.
+Return:
+  Index of the function on success; CFG_HASH_EMPTY if it is not found.
+******************************************************************************/
+static int cfg_find_func(const cfg_t *cfg, const cfg_func_valid_t *fun) {
+  const cfg_hash_t *tab = &((cfg_index_t *) cfg->index)->func;
+  if (!tab->num) return CFG_HASH_EMPTY;
+  const cfg_func_valid_t *funcs = (cfg_func_valid_t *) cfg->funcs;
+  const uint32_t hash = cfg_hash_func(fun);
+
+  size_t i = hash & (tab->cap - 1);
+  while (tab->slot[i].idx != CFG_HASH_EMPTY) {
+    const int j = tab->slot[i].idx;
+    if (tab->slot[i].hash == hash && funcs[j].func == fun->func &&
+        funcs[j].args == fun->args) return j;
+    i = (i + 1) & (tab->cap - 1);
+  }
+  return CFG_HASH_EMPTY;
+}
+
+/******************************************************************************
+Function `cfg_trace`:
+  Report an event to the tracing callback.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `type`:     type of the event;
+  * `name`:     filename, parameter name, or message of the event;
+  * `dtype`:    data type of the converted parameter;
+  * `num`:      number of bytes read or elements converted;
+  * `start`:    starting time of the event;
+  * `end`:      ending time of the event.
+******************************************************************************/
+static void cfg_trace(const cfg_t *cfg, const cfg_event_type_t type,
+    const char *name, const cfg_dtype_t dtype, const size_t num,
+    const double start, const double end) {
+  const cfg_trace_t *trace = (cfg_trace_t *) cfg->trace;
+  cfg_event_t event;
+  event.type = type;
+  event.name = name;
+  event.dtype = dtype;
+  event.num = num;
+  event.start = start;
+  event.duration = end - start;
+  trace->func(&event, trace->ctx);
+}
+
 /******************************************************************************
 Function `cfg_msg`:
   Append warning/error message to the error handler.
@@ -190,7 +1150,7 @@ static void cfg_msg(cfg_t *cfg, const char *msg, const char *key) {
     }
     if (len > max) max = len;           /* the size is still not enough */
 
-    tmp = realloc(err->msg, max);
+    tmp = cfg_realloc(cfg->alloc, err->msg, max);
     if (!tmp) {
       err->errno = CFG_ERR_MEMORY;
       return;
@@ -209,35 +1169,333 @@ static void cfg_msg(cfg_t *cfg, const char *msg, const char *key) {
   }
   err->len = len;
   err->num += 1;
+  CFG_STAT_ADD(cfg, nwarn, 1);    /* including errors */
+  if (cfg->trace) {
+    const double now = cfg_time();
+    cfg_trace(cfg, CFG_EVENT_MESSAGE, tmp, CFG_DTYPE_NULL, 0, now, now);
+  }
 }
 
 
 /*============================================================================*\
-              Functions for initialising parameters and functions
+                 Functions for the memory arena of the values
 \*============================================================================*/
 
 /******************************************************************************
-Function `cfg_init`:
-  Initialise the entry for all parameters and command line functions.
-Return:
-  The address of the structure.
+Function `cfg_arena_release`:
+  Return a chunk of memory to the arena, for being reused later.
+Arguments:
+  * `arena`:    the memory arena;
+  * `mem`:      the chunk of memory;
+  * `size`:     size of the chunk.
 ******************************************************************************/
-cfg_t *cfg_init(void) {
-  cfg_t *cfg = calloc(1, sizeof(cfg_t));
-  if (!cfg) return NULL;
+static void cfg_arena_release(cfg_arena_t *arena, void *mem,
+    const size_t size) {
+  if (!mem || size < CFG_ARENA_ROUND(sizeof(cfg_arena_chunk_t))) return;
+  cfg_arena_chunk_t *chunk = (cfg_arena_chunk_t *) mem;
+  chunk->size = size;
+  chunk->next = arena->free;
+  arena->free = chunk;
+}
 
-  cfg_error_t *err = calloc(1, sizeof(cfg_error_t));
-  if (!err) {
-    free(cfg);
-    return NULL;
+/******************************************************************************
+Function `cfg_arena_alloc`:
+  Allocate a chunk of memory from the arena, by reusing a released chunk if
+  possible, or taking the unused space of the memory blocks.
+Arguments:
+  * `arena`:    the memory arena;
+  * `size`:     requested size of the memory, updated to the actual size;
+  * `alloc`:    the allocation functions for the memory blocks.
+Return:
+  Address of the allocated memory on success; NULL on error.
+******************************************************************************/
+static void *cfg_arena_alloc(cfg_arena_t *arena, size_t *size,
+    const cfg_allocator_t *alloc) {
+  const size_t min = CFG_ARENA_ROUND(sizeof(cfg_arena_chunk_t));
+  const size_t head = CFG_ARENA_ROUND(sizeof(cfg_arena_block_t));
+  if (*size > SIZE_MAX - head - CFG_ARENA_ALIGN) return NULL;
+  size_t num = (*size < min) ? min : CFG_ARENA_ROUND(*size);
+
+  /* First fit from the released chunks, with the remaining space split. */
+  for (cfg_arena_chunk_t **prev = &arena->free; *prev; prev = &(*prev)->next) {
+    cfg_arena_chunk_t *chunk = *prev;
+    if (chunk->size < num) continue;
+    *prev = chunk->next;
+    if (chunk->size - num >= min)
+      cfg_arena_release(arena, (char *) chunk + num, chunk->size - num);
+    else num = chunk->size;
+    *size = num;
+    return chunk;
+  }
+
+  /* Take the space at the end of the current block. */
+  cfg_arena_block_t *blk = arena->block;
+  if (blk && blk->size - blk->used >= num) {
+    void *mem = (char *) blk + head + blk->used;
+    blk->used += num;
+    *size = num;
+    return mem;
+  }
+
+  /* Allocate a dedicated block for large chunks, to keep using the current
+   * block for the small ones. */
+  if (blk && num > CFG_ARENA_BLOCK_SIZE / 4) {
+    cfg_arena_block_t *large = cfg_malloc(alloc, head + num);
+    if (!large) return NULL;
+    large->size = large->used = num;
+    large->next = blk->next;
+    blk->next = large;
+    *size = num;
+    return (char *) large + head;
+  }
+
+  /* Start a new block, and recycle the unused space of the current one. */
+  const size_t bsize = (num > CFG_ARENA_BLOCK_SIZE) ?
+    num : CFG_ARENA_BLOCK_SIZE;
+  cfg_arena_block_t *next = cfg_malloc(alloc, head + bsize);
+  if (!next) return NULL;
+  if (blk) {
+    cfg_arena_release(arena, (char *) blk + head + blk->used,
+        blk->size - blk->used);
+    blk->used = blk->size;
+  }
+  next->size = bsize;
+  next->used = num;
+  next->next = blk;
+  arena->block = next;
+  *size = num;
+  return (char *) next + head;
+}
+
+/******************************************************************************
+Function `cfg_alloc_value`:
+  Allocate zero-initialised memory for the value of a parameter, either from
+  the arena, or using the allocation functions.  Memory from the arena that
+  is previously taken by the parameter is reused if it is large enough, or
+  released.
+Arguments:
+  * `cfg`:      entry for all configurations;
+  * `par`:      address of the verified configuration parameter;
+  * `num`:      number of elements;
+  * `size`:     size of each element.
+Return:
+  Address of the allocated memory on success; NULL on error.
+******************************************************************************/
+static void *cfg_alloc_value(cfg_t *cfg, cfg_param_valid_t *par,
+    const size_t num, const size_t size) {
+  cfg_arena_t *arena = (cfg_arena_t *) cfg->arena;
+  if (!arena) {
+    CFG_STAT_ADD(cfg, nalloc[par->dtype], 1);
+    CFG_STAT_ADD(cfg, salloc[par->dtype], num * size);
+    return cfg_calloc(cfg->alloc, num, size);
+  }
+  if (size && num > SIZE_MAX / size) return NULL;
+
+  size_t len = num * size;
+  if (!par->mem || len > par->msize) {
+    void *mem = cfg_arena_alloc(arena, &len, cfg->alloc);
+    if (!mem) return NULL;
+    CFG_STAT_ADD(cfg, nalloc[par->dtype], 1);
+    CFG_STAT_ADD(cfg, salloc[par->dtype], len);
+    cfg_arena_release(arena, par->mem, par->msize);
+    par->mem = mem;
+    par->msize = len;
+  }
+  return memset(par->mem, 0, num * size);
+}
+
+
+/*============================================================================*\
+              Functions for initialising parameters and functions
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_init`:
+  Initialise the entry for all parameters and command line functions.
+Return:
+  The address of the structure.
+******************************************************************************/
+cfg_t *cfg_init(void) {
+  return cfg_init_with_allocator(NULL);
+}
+
+/******************************************************************************
+Function `cfg_init_with_allocator`:
+  Initialise the entry for all parameters and command line functions, with
+  all the memory allocated by the given functions.
+Arguments:
+  * `alloc`:    the allocation functions, or NULL for the standard ones.
+Return:
+  The address of the structure; NULL on error.
+******************************************************************************/
+cfg_t *cfg_init_with_allocator(const cfg_allocator_t *alloc) {
+  cfg_allocator_t *copy = NULL;
+  if (alloc) {
+    if (!alloc->malloc || !alloc->realloc || !alloc->free) return NULL;
+    if (!(copy = alloc->malloc(sizeof(cfg_allocator_t), alloc->ctx)))
+      return NULL;
+    *copy = *alloc;
+  }
+
+  /* The copy of the functions is released by itself. */
+  cfg_t *cfg = cfg_calloc(copy, 1, sizeof(cfg_t));
+  if (!cfg) {
+    cfg_free(copy, copy);
+    return NULL;
+  }
+
+  cfg_index_t *index = cfg_calloc(copy, 1, sizeof(cfg_index_t));
+  if (!index) {
+    cfg_free(copy, cfg);
+    cfg_free(copy, copy);
+    return NULL;
+  }
+  for (int i = 0; i <= UCHAR_MAX; i++) index->opt[i] = CFG_HASH_EMPTY;
+  index->name.slot = index->lopt.slot = NULL;
+  index->func.slot = index->var.slot = NULL;
+
+  cfg_error_t *err = cfg_calloc(copy, 1, sizeof(cfg_error_t));
+  if (!err) {
+    cfg_free(copy, index);
+    cfg_free(copy, cfg);
+    cfg_free(copy, copy);
+    return NULL;
   }
   err->msg = NULL;
 
-  cfg->params = cfg->funcs = NULL;
+  cfg->params = cfg->funcs = cfg->reader = NULL;
+  cfg->arena = cfg->source = cfg->watch = cfg->shared = NULL;
+  cfg->stats = cfg->trace = NULL;
+  cfg->nthread = 1;
+  cfg->index = index;
+  cfg->alloc = copy;
   cfg->error = err;
   return cfg;
 }
 
+/******************************************************************************
+Function `cfg_use_arena`:
+  Allocate memory for all the subsequently retrieved strings and arrays from
+  blocks owned by the entry, which are released by `cfg_destroy`.
+Arguments:
+  * `cfg`:      entry for all configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_use_arena(cfg_t *cfg) {
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->arena) return 0;
+
+  cfg_arena_t *arena = cfg_calloc(cfg->alloc, 1, sizeof(cfg_arena_t));
+  if (!arena) {
+    cfg_msg(cfg, "failed to allocate memory for the arena", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  arena->block = NULL;
+  arena->free = NULL;
+  cfg->arena = arena;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_keep_source`:
+  Keep the subsequently parsed configuration text alive until `cfg_destroy`,
+  and let string variables point directly to the values in it.
+Arguments:
+  * `cfg`:      entry for all configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_keep_source(cfg_t *cfg) {
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->source) return 0;
+
+  cfg_source_t *source = cfg_calloc(cfg->alloc, 1, sizeof(cfg_source_t));
+  if (!source) {
+    cfg_msg(cfg, "failed to allocate memory for the configuration text",
+        NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  source->buf = NULL;
+  cfg->source = source;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_set_threads`:
+  Set the maximum number of threads for converting large numerical arrays,
+  which takes effect only with CFG_ENABLE_THREADS.
+Arguments:
+  * `cfg`:      entry for all configurations;
+  * `nthread`:  the maximum number of threads.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_set_threads(cfg_t *cfg, const int nthread) {
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (nthread <= 0) {
+    cfg_msg(cfg, "invalid number of threads", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  cfg->nthread = nthread;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_use_stats`:
+  Start collecting statistics of the subsequent parsing, which takes effect
+  only with CFG_ENABLE_STATS.
+Arguments:
+  * `cfg`:      entry for all configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_use_stats(cfg_t *cfg) {
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+#ifdef CFG_ENABLE_STATS
+  if (cfg->stats) return 0;
+  if (!(cfg->stats = cfg_calloc(cfg->alloc, 1, sizeof(cfg_stats_t)))) {
+    cfg_msg(cfg, "failed to allocate memory for the statistics", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+#endif
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_set_trace`:
+  Register a callback for tracing the subsequent parsing, or remove it.
+Arguments:
+  * `cfg`:      entry for all configurations;
+  * `func`:     the callback function, or NULL for removing the callback;
+  * `ctx`:      context passed to the callback.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_set_trace(cfg_t *cfg, cfg_trace_func_t func, void *ctx) {
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (!func) {
+    if (cfg->trace) cfg_free(cfg->alloc, cfg->trace);
+    cfg->trace = NULL;
+    return 0;
+  }
+
+  cfg_trace_t *trace = (cfg_trace_t *) cfg->trace;
+  if (!trace && !(trace = cfg_malloc(cfg->alloc, sizeof(cfg_trace_t)))) {
+    cfg_msg(cfg, "failed to allocate memory for the tracing callback", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  trace->func = func;
+  trace->ctx = ctx;
+  cfg->trace = trace;
+  return 0;
+}
+
 /******************************************************************************
 Function `cfg_set_params`:
   Verify and register configuration parameters.
@@ -257,15 +1515,25 @@ int cfg_set_params(cfg_t *cfg, const cfg_param_t *param, const int npar) {
     return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
   }
 
-  /* Allocate memory for parameters. */
-  cfg_param_valid_t *vpar = realloc(cfg->params,
-      (npar + cfg->npar) * sizeof *vpar);
-  if (!vpar) {
-    cfg_msg(cfg, "failed to allocate memory for parameters", NULL);
-    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  if (npar > INT_MAX - cfg->npar) {
+    cfg_msg(cfg, "too many parameters to be registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  /* Allocate memory for parameters, with geometrically growing capacity. */
+  cfg_index_t *index = (cfg_index_t *) cfg->index;
+  cfg_param_valid_t *vpar = (cfg_param_valid_t *) cfg->params;
+  if ((size_t) (npar + cfg->npar) > index->pcap) {
+    size_t cap = cfg_grow_size(index->pcap, npar + cfg->npar, sizeof *vpar);
+    if (!cap || !(vpar = cfg_realloc(cfg->alloc, cfg->params,
+        cap * sizeof *vpar))) {
+      cfg_msg(cfg, "failed to allocate memory for parameters", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    }
+    cfg->params = vpar;
+    index->pcap = cap;
   }
   memset(vpar + cfg->npar, 0, npar * sizeof *vpar);
-  cfg->params = vpar;
 
   /* Register parameters. */
   for (int i = 0; i < npar; i++) {
@@ -274,7 +1542,7 @@ int cfg_set_params(cfg_t *cfg, const cfg_param_t *param, const int npar) {
     par->dtype = CFG_DTYPE_NULL;
     par->src = CFG_SRC_NULL;
     par->name = par->lopt = par->value = NULL;
-    par->var = NULL;
+    par->var = par->mem = NULL;
 
     /* Create the string for the current index and short option. */
     char tmp[CFG_NUM_MAX_SIZE(int)];
@@ -342,35 +1610,39 @@ int cfg_set_params(cfg_t *cfg, const cfg_param_t *param, const int npar) {
 
     tmp[0] = par->opt;
     tmp[1] = '\0';
-    /* Check duplicates with the registered parameters. */
-    for (j = 0; j < cfg->npar + i; j++) {
-      if (!strncmp(par->name, vpar[j].name, par->nlen)) {
-        cfg_msg(cfg, "duplicate parameter name", par->name);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
-      if (par->opt && par->opt == vpar[j].opt) {
-        cfg_msg(cfg, "duplicate short command line option", tmp);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
-      if (par->lopt && vpar[j].lopt &&
-          !strncmp(par->lopt, vpar[j].lopt, par->llen)) {
-        cfg_msg(cfg, "duplicate long command line option", par->lopt);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
+    /* Check duplicates with the registered parameters and functions. */
+    if (cfg_find_name(cfg, par->name) != CFG_HASH_EMPTY) {
+      cfg_msg(cfg, "duplicate parameter name", par->name);
+      return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
+    }
+    if (par->opt && index->opt[(unsigned char) par->opt] != CFG_HASH_EMPTY) {
+      cfg_msg(cfg, "duplicate short command line option", tmp);
+      return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
+    }
+    if (par->lopt && cfg_find_lopt(cfg, par->lopt) != CFG_HASH_EMPTY) {
+      cfg_msg(cfg, "duplicate long command line option", par->lopt);
+      return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
     }
 
-    /* Check duplicates with the registered functions. */
-    cfg_func_valid_t *cfunc = (cfg_func_valid_t *) cfg->funcs;
-    for (j = 0; j < cfg->nfunc; j++) {
-      if (par->opt && par->opt == cfunc[j].opt) {
-        cfg_msg(cfg, "duplicate short command line option", tmp);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
-      if (par->lopt && cfunc[j].lopt &&
-          !strncmp(par->lopt, cfunc[j].lopt, par->llen)) {
-        cfg_msg(cfg, "duplicate long command line option", par->lopt);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
+    /* Index the parameter name and command line options. */
+    size_t len;
+    if (cfg_hash_insert(&index->name, cfg_hash_str(par->name, &len),
+        cfg->npar + i, cfg->alloc) || (par->lopt &&
+        cfg_hash_insert(&index->lopt, cfg_hash_str(par->lopt, &len),
+        cfg->npar + i, cfg->alloc))) {
+      cfg_msg(cfg, "failed to allocate memory for indexing parameter",
+          par->name);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    }
+    if (par->opt) index->opt[(unsigned char) par->opt] = cfg->npar + i;
+
+    /* Only the first parameter is indexed for a given variable. */
+    if (cfg_find_var(cfg, par->var) == CFG_HASH_EMPTY &&
+        cfg_hash_insert(&index->var, cfg_hash_mem(CFG_HASH_OFFSET,
+        &par->var, sizeof par->var), cfg->npar + i, cfg->alloc)) {
+      cfg_msg(cfg, "failed to allocate memory for indexing parameter",
+          par->name);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
     }
   }
 
@@ -397,15 +1669,25 @@ int cfg_set_funcs(cfg_t *cfg, const cfg_func_t *func, const int nfunc) {
     return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
   }
 
-  /* Allocate memory for command line functions. */
-  cfg_func_valid_t *vfunc = realloc(cfg->funcs,
-      (nfunc + cfg->nfunc) * sizeof *vfunc);
-  if (!vfunc) {
-    cfg_msg(cfg, "failed to allocate memory for functions", NULL);
-    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  if (nfunc > INT_MAX - cfg->nfunc) {
+    cfg_msg(cfg, "too many functions to be registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  /* Allocate memory for functions, with geometrically growing capacity. */
+  cfg_index_t *index = (cfg_index_t *) cfg->index;
+  cfg_func_valid_t *vfunc = (cfg_func_valid_t *) cfg->funcs;
+  if ((size_t) (nfunc + cfg->nfunc) > index->fcap) {
+    size_t cap = cfg_grow_size(index->fcap, nfunc + cfg->nfunc, sizeof *vfunc);
+    if (!cap || !(vfunc = cfg_realloc(cfg->alloc, cfg->funcs,
+        cap * sizeof *vfunc))) {
+      cfg_msg(cfg, "failed to allocate memory for functions", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    }
+    cfg->funcs = vfunc;
+    index->fcap = cap;
   }
   memset(vfunc + cfg->nfunc, 0, nfunc * sizeof *vfunc);
-  cfg->funcs = vfunc;
 
   /* Register command line functions. */
   for (int i = 0; i < nfunc; i++) {
@@ -458,41 +1740,35 @@ int cfg_set_funcs(cfg_t *cfg, const cfg_func_t *func, const int nfunc) {
     }
     fun->args = func[i].args;
 
-    /* Check duplicates with the registered functions. */
-    for (j = 0; j < cfg->nfunc + i; j++) {
+    /* Check duplicates with the registered functions and parameters. */
+    if (cfg_find_func(cfg, fun) != CFG_HASH_EMPTY) {
       /* Function and arguments cannot both be identical. */
-      if (fun->func == vfunc[j].func && fun->args == vfunc[j].args) {
-        cfg_msg(cfg, "duplicate function with index", tmp);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
-      if (fun->opt && fun->opt == vfunc[j].opt) {
-        tmp[0] = fun->opt;
-        tmp[1] = '\0';
-        cfg_msg(cfg, "duplicate short command line option", tmp);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
-      if (fun->lopt && vfunc[j].lopt &&
-          !strncmp(fun->lopt, vfunc[j].lopt, fun->llen)) {
-        cfg_msg(cfg, "duplicate long command line option", fun->lopt);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
+      cfg_msg(cfg, "duplicate function with index", tmp);
+      return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
+    }
+    if (fun->opt && index->opt[(unsigned char) fun->opt] != CFG_HASH_EMPTY) {
+      tmp[0] = fun->opt;
+      tmp[1] = '\0';
+      cfg_msg(cfg, "duplicate short command line option", tmp);
+      return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
+    }
+    if (fun->lopt && cfg_find_lopt(cfg, fun->lopt) != CFG_HASH_EMPTY) {
+      cfg_msg(cfg, "duplicate long command line option", fun->lopt);
+      return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
     }
 
-    /* Check duplicates with the registered parameters. */
-    cfg_param_valid_t *cpar = (cfg_param_valid_t *) cfg->params;
-    for (j = 0; j < cfg->npar; j++) {
-      if (fun->opt && fun->opt == cpar[j].opt) {
-        tmp[0] = fun->opt;
-        tmp[1] = '\0';
-        cfg_msg(cfg, "duplicate short command line option", tmp);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
-      if (fun->lopt && cpar[j].lopt &&
-          !strncmp(fun->lopt, cpar[j].lopt, fun->llen)) {
-        cfg_msg(cfg, "duplicate long command line option", fun->lopt);
-        return CFG_ERRNO(cfg) = CFG_ERR_EXIST;
-      }
+    /* Index the function and command line options. */
+    size_t len;
+    if (cfg_hash_insert(&index->func, cfg_hash_func(fun), cfg->nfunc + i,
+        cfg->alloc) || (fun->lopt && cfg_hash_insert(&index->lopt,
+        cfg_hash_str(fun->lopt, &len), CFG_INDEX_OF_FUNC(cfg->nfunc + i),
+        cfg->alloc))) {
+      cfg_msg(cfg, "failed to allocate memory for indexing function index",
+          tmp);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
     }
+    if (fun->opt)
+      index->opt[(unsigned char) fun->opt] = CFG_INDEX_OF_FUNC(cfg->nfunc + i);
   }
 
   cfg->nfunc += nfunc;
@@ -501,271 +1777,895 @@ int cfg_set_funcs(cfg_t *cfg, const cfg_func_t *func, const int nfunc) {
 
 
 /*============================================================================*\
-          Functions for parsing configurations represented by strings
+                 Functions for converting strings to values
 \*============================================================================*/
 
+#if FLT_EVAL_METHOD == 0
+/* Exact powers of 10 for the Clinger fast path. */
+static const double cfg_pow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif
+
 /******************************************************************************
-Function `cfg_parse_line`:
-  Read the configuration from a line of a configration file.
+Function `cfg_conv_bool`:
+  Convert a string to a boolean value.
 Arguments:
-  * `line`:     the null terminated string line;
-  * `len`:      length of the line, NOT including the first '\0';
-  * `key`:      address of the retrieved keyword;
-  * `value`:    address of the retrieved value;
-  * `state`:    initial state for the parser.
+  * `str`:      the null terminated string;
+  * `var`:      address of the variable for the converted value.
 Return:
-  Parser status.
+  Zero on success; non-zero on error.
 ******************************************************************************/
-static cfg_parse_return_t cfg_parse_line(char *line, const size_t len,
-    char **key, char **value, cfg_parse_state_t state) {
-  if (!line || *line == '\0' || len == 0) return CFG_PARSE_PASS;
-  char quote = '\0';            /* handle quotation marks */
-  char *newline;                /* handle line continuation */
-  for (size_t i = 0; i < len; i++) {
-    char c = line[i];
-    switch (state) {
-      case CFG_PARSE_START:
-        if (isalpha(c) || c == '_') {
-          *key = line + i;
-          state = CFG_PARSE_KEYWORD;
-        }
-        else if (c == CFG_SYM_COMMENT) return CFG_PARSE_PASS;
-        else if (!isspace(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_KEYWORD:
-        if (c == CFG_SYM_EQUAL || isspace(c)) {
-          /* check if the keyword is too long */
-          if (line + i - *key >= CFG_MAX_NAME_LEN) return CFG_PARSE_ERROR;
-          line[i] = '\0';                       /* terminate the keyword */
-          state = (c == CFG_SYM_EQUAL) ?
-            CFG_PARSE_VALUE_START : CFG_PARSE_EQUAL;
-        }
-        else if (!isalnum(c) && c != '_') return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_EQUAL:
-        if (c == CFG_SYM_EQUAL) state = CFG_PARSE_VALUE_START;
-        else if (!isspace(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_VALUE_START:
-        if (c == '"' || c == '\'') {            /* enter quotes */
-          quote = c;
-          *value = line + i;
-          state = CFG_PARSE_QUOTE;
-        }
-        else if (c == CFG_SYM_ARRAY_START) {    /* beginning of array */
-          *value = line + i;
-          state = CFG_PARSE_ARRAY_START;
-        }
-        else if (c == CFG_SYM_COMMENT) return CFG_PARSE_PASS;   /* no value */
-        else if (isgraph(c)) {                  /* beginning of value */
-          *value = line + i;
-          state = CFG_PARSE_VALUE;
-        }
-        else if (!isspace(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_ARRAY_START:
-        if (c == CFG_SYM_ARRAY_SEP || c == CFG_SYM_ARRAY_END ||
-            c == CFG_SYM_COMMENT)               /* no value is found */
-          return CFG_PARSE_ERROR;
-        else if (c == '"' || c == '\'')  {      /* enter quotes */
-          quote = c;
-          state = CFG_PARSE_ARRAY_QUOTE;
-        }
-        else if (c == CFG_SYM_NEWLINE) {        /* line continuation */
-          newline = line + i;
-          state = CFG_PARSE_ARRAY_NEWLINE;
-        }
-        else if (isgraph(c)) state = CFG_PARSE_ARRAY_VALUE;
-        else if (!isspace(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_VALUE:
-        if (c == CFG_SYM_COMMENT) {
-          line[i] = '\0';                       /* terminate the value */
-          return CFG_PARSE_DONE;
-        }
-        else if (!isprint(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_ARRAY_VALUE:
-        if (c == CFG_SYM_ARRAY_SEP)             /* new array element */
-          state = CFG_PARSE_ARRAY_START;
-        else if (c == CFG_SYM_ARRAY_END)        /* end of array */
-          state = CFG_PARSE_ARRAY_END;
-        else if (c == CFG_SYM_COMMENT || !isprint(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_QUOTE:
-        if (c == quote) state = CFG_PARSE_QUOTE_END;
-        break;
-      case CFG_PARSE_ARRAY_QUOTE:
-        if (c == quote) state = CFG_PARSE_ARRAY_QUOTE_END;
-        break;
-      case CFG_PARSE_QUOTE_END:
-      case CFG_PARSE_ARRAY_END:
-        if (c == CFG_SYM_COMMENT) {
-          line[i] = '\0';
-          return CFG_PARSE_DONE;
-        }
-        else if (!isspace(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_ARRAY_QUOTE_END:
-        if (c == CFG_SYM_ARRAY_SEP) state = CFG_PARSE_ARRAY_START;
-        else if (c == CFG_SYM_ARRAY_END) state = CFG_PARSE_ARRAY_END;
-        else if (!isspace(c)) return CFG_PARSE_ERROR;
-        break;
-      case CFG_PARSE_ARRAY_NEWLINE:             /* line continuation */
-        if (c == CFG_SYM_COMMENT) {             /* clear all characters */
-          state = CFG_PARSE_CLEAN;
-          line[i] = ' ';
-          *newline = ' ';
-        }
-        else if (!isspace(c)) {         /* not really for line continuation */
-          newline = NULL;
-          state = CFG_PARSE_ARRAY_VALUE;
-          i--;
-        }
-        break;
-      case CFG_PARSE_CLEAN:
-        line[i] = ' ';
-        break;
-      default:
-        return CFG_PARSE_ERROR;
-    }
-  }
-
-  /* Check the final status. */
-  switch (state) {
-    case CFG_PARSE_VALUE:
-    case CFG_PARSE_QUOTE_END:
-    case CFG_PARSE_ARRAY_END:
-      return CFG_PARSE_DONE;
-    case CFG_PARSE_START:
-    case CFG_PARSE_VALUE_START:
-      return CFG_PARSE_PASS;
-    case CFG_PARSE_ARRAY_NEWLINE:
-      *newline = ' ';
-    case CFG_PARSE_CLEAN:
-      return CFG_PARSE_CONTINUE;
+static int cfg_conv_bool(const char *str, bool *var) {
+  /* Accept "1", "T", "t", "true", "TRUE", "True", and the counterparts. */
+  switch (str[0]) {
+    case '1':
+      if (str[1] != '\0') return CFG_ERR_PARSE;
+      *var = true;
+      return 0;
+    case '0':
+      if (str[1] != '\0') return CFG_ERR_PARSE;
+      *var = false;
+      return 0;
+    case 'T':
+      if (str[1] != '\0' && strcmp(str + 1, "RUE") && strcmp(str + 1, "rue"))
+        return CFG_ERR_PARSE;
+      *var = true;
+      return 0;
+    case 't':
+      if (str[1] != '\0' && strcmp(str + 1, "rue")) return CFG_ERR_PARSE;
+      *var = true;
+      return 0;
+    case 'F':
+      if (str[1] != '\0' && strcmp(str + 1, "ALSE") && strcmp(str + 1, "alse"))
+        return CFG_ERR_PARSE;
+      *var = false;
+      return 0;
+    case 'f':
+      if (str[1] != '\0' && strcmp(str + 1, "alse")) return CFG_ERR_PARSE;
+      *var = false;
+      return 0;
     default:
-      return CFG_PARSE_ERROR;
+      return CFG_ERR_PARSE;
   }
 }
 
 /******************************************************************************
-Function `cfg_parse_array`:
-  Split the string defined as array, and count the number of elements.
+Function `cfg_conv_long`:
+  Convert the leading part of a string to a decimal integer in a range.
 Arguments:
-  * `par`:      address of the verified configuration parameter.
+  * `str`:      the null terminated string;
+  * `min`:      the minimum allowed value;
+  * `max`:      the maximum allowed value;
+  * `var`:      address of the variable for the converted value.
 Return:
-  Zero on success; non-zero on error.
+  Number of characters converted; 0 on error.
 ******************************************************************************/
-static int cfg_parse_array(cfg_param_valid_t *par) {
-  par->narr = 0;                /* no need to check whether `par` is NULL */
-  if (!par->value || !par->vlen) return 0;              /* empty string */
+static size_t cfg_conv_long(const char *str, const long min, const long max,
+    long *var) {
+  const char *p = str;
+  while (CFG_IS_SPACE(*p)) p++;
+  const bool neg = (*p == '-');
+  if (*p == '-' || *p == '+') p++;
+  if (!CFG_IS_DIGIT(*p)) return 0;
 
-  int n = 0;
-  char quote = '\0';
-  cfg_parse_state_t state = CFG_PARSE_START;
-  char *start, *end;
-  start = end = NULL;
-
-  for (size_t i = 0; i < par->vlen; i++) {
-    if (state == CFG_PARSE_ARRAY_DONE) break;
-    char c = par->value[i];             /* this is surely not '\0' */
-
-    switch (state) {
-      case CFG_PARSE_START:
-        if (c == CFG_SYM_ARRAY_START) {
-          state = CFG_PARSE_ARRAY_START;
-          start = par->value + i;       /* mark the array starting point */
-        }
-        else if (!isspace(c)) {                 /* not an array */
-          par->narr = 1;        /* try to parse as a single variable later */
-          return 0;
-        }
-        break;
-      case CFG_PARSE_ARRAY_START:
-        if (c == CFG_SYM_ARRAY_SEP || c == CFG_SYM_ARRAY_END ||
-            c == CFG_SYM_COMMENT)               /* no value is found */
-          return CFG_ERR_VALUE;
-        else if (c == '"' || c == '\'')  {      /* enter quotes */
-          quote = c;
-          state = CFG_PARSE_ARRAY_QUOTE;
-        }
-        else if (isgraph(c)) state = CFG_PARSE_ARRAY_VALUE;
-        else if (!isspace(c)) return CFG_ERR_VALUE;
-        break;
-      case CFG_PARSE_ARRAY_VALUE:
-        if (c == CFG_SYM_ARRAY_SEP) {      /* new array element */
-          n++;
-          state = CFG_PARSE_ARRAY_START;
-          par->value[i] = '\0';         /* add separator for value parser */
-        }
-        else if (c == CFG_SYM_ARRAY_END) {      /* end of array */
-          state = CFG_PARSE_ARRAY_END;
-          end = par->value + i;         /* mark the array ending point */
-        }
-        else if (c == CFG_SYM_COMMENT || !isprint(c)) return CFG_ERR_VALUE;
-        break;
-      case CFG_PARSE_ARRAY_QUOTE:
-        if (c == quote) {
-          quote = '\0';
-          state = CFG_PARSE_ARRAY_QUOTE_END;
-        }
-        break;
-      case CFG_PARSE_ARRAY_QUOTE_END:
-        if (c == CFG_SYM_ARRAY_SEP) {           /* new array element */
-          n++;
-          state = CFG_PARSE_ARRAY_START;
-          par->value[i] = '\0';         /* add separator for value parser */
-        }
-        else if (c == CFG_SYM_ARRAY_END) {      /* end of array */
-          state = CFG_PARSE_ARRAY_END;
-          end = par->value + i;         /* mark the array ending point */
-        }
-        else if (!isspace(c)) return CFG_ERR_VALUE;
-        break;
-      case CFG_PARSE_ARRAY_END:
-        if (c == CFG_SYM_COMMENT) {
-          state = CFG_PARSE_ARRAY_DONE;
-          par->value[i] = '\0';         /* terminate earlier to skip comments */
-        }
-        else if (isgraph(c)) return CFG_ERR_VALUE;
-        break;
-      default:
-        return CFG_ERR_VALUE;
-    }
+  /* Accumulate the magnitude, and check overflow against the limit. */
+  const unsigned long lim = neg ? (unsigned long) -(min + 1) + 1 :
+      (unsigned long) max;
+  unsigned long num = 0;
+  do {
+    const unsigned d = *p++ - '0';
+    if (num > (lim - d) / 10) return 0;
+    num = num * 10 + d;
   }
-  par->value = start + 1;       /* omit the starting '[' */
-  *end = '\0';                  /* remove the ending ']' */
-  par->narr = n + 1;
-  return 0;
+  while (CFG_IS_DIGIT(*p));
+
+  *var = neg ? (num ? -(long) (num - 1) - 1 : 0) : (long) num;
+  return p - str;
 }
 
 /******************************************************************************
-Function `cfg_get_value`:
-  Retrieve the parameter value and assign it to a variable.
+Function `cfg_scan_real`:
+  Scan the leading part of a string for a floating-point number, and compute
+  it directly if the result is guaranteed to be correctly rounded.
 Arguments:
-  * `var`:      pointer to the variable to be assigned value;
-  * `str`:      string storing the parameter value;
-  * `size`:     length of `value`, including the ending '\0';
-  * `dtype`:    data type;
-  * `src`:      source of this value.
+  * `str`:      the null terminated string;
+  * `flt`:      true for single precision and false for double precision;
+  * `var`:      address for the computed value;
+  * `exact`:    address of the flag indicating whether `var` is computed.
 Return:
-  Zero on success; non-zero on error.
+  Number of characters in the number; 0 if the string is not a number.
 ******************************************************************************/
-static int cfg_get_value(void *var, char *str, const size_t size,
-    const cfg_dtype_t dtype, int src) {
-  if (!str || !size) return 0;
-  char *value = str;
-  int n;
+static size_t cfg_scan_real(const char *str, const bool flt, double *var,
+    bool *exact) {
+  const char *p = str;
+  *exact = false;
+  while (CFG_IS_SPACE(*p)) p++;
+  const bool neg = (*p == '-');
+  if (*p == '-' || *p == '+') p++;
 
-  /* Validate the value. */
-  while (*value && isspace(*value)) value++;          /* omit whitespaces */
-  if (*value == '\0') return CFG_ERR_VALUE;           /* empty string */
-  if (*value == '"' || *value == '\'') {              /* remove quotes */
-    char quote = *value;
-    value++;
-    for (n = 0; value[n]; n++) {      /* the string is surely terminated */
-      if (value[n] == quote) {
+  /* Special values, case-insensitive. */
+  if ((p[0] | 0x20) == 'i' && (p[1] | 0x20) == 'n' && (p[2] | 0x20) == 'f') {
+    p += 3;
+    const char *inf = "inity";
+    int i;
+    for (i = 0; i < 5; i++) if ((p[i] | 0x20) != inf[i]) break;
+    if (i == 5) p += 5;
+    *var = neg ? -HUGE_VAL : HUGE_VAL;
+    *exact = true;
+    return p - str;
+  }
+  if ((p[0] | 0x20) == 'n' && (p[1] | 0x20) == 'a' && (p[2] | 0x20) == 'n') {
+    p += 3;
+    if (*p == '(') {                    /* optional n-char-sequence */
+      const char *q = p + 1;
+      while (CFG_IS_ALNUM(*q) || *q == '_') q++;
+      if (*q == ')') p = q + 1;
+    }
+    *var = neg ? -NAN : NAN;
+    *exact = true;
+    return p - str;
+  }
+  /* Hexadecimal numbers are left to the fallback converter. */
+  if (p[0] == '0' && (p[1] | 0x20) == 'x') {
+    const char *q = p + 2;
+    bool xdigit = false;
+    for (; CFG_IS_XDIGIT(*q); q++) xdigit = true;
+    if (*q == '.') for (q++; CFG_IS_XDIGIT(*q); q++) xdigit = true;
+    if (!xdigit) return p + 1 - str;            /* only "0" is converted */
+    if ((*q | 0x20) == 'p') {
+      const char *e = q + 1;
+      if (*e == '-' || *e == '+') e++;
+      if (CFG_IS_DIGIT(*e)) {
+        while (CFG_IS_DIGIT(*e)) e++;
+        q = e;
+      }
+    }
+    return q - str;
+  }
+
+  /* Decimal significand, with at most 19 significant digits retained. */
+  uint64_t man = 0;
+  int ndig = 0, exp10 = 0;
+  bool trunc = false, digit = false;
+  while (*p == '0') {
+    p++;
+    digit = true;
+  }
+  for (; CFG_IS_DIGIT(*p); p++) {
+    digit = true;
+    if (ndig < 19) {
+      man = man * 10 + (*p - '0');
+      ndig++;
+    }
+    else {
+      if (*p != '0') trunc = true;
+      exp10++;
+    }
+  }
+  if (*p == '.') {
+    p++;
+    if (!ndig) {
+      while (*p == '0') {
+        p++;
+        exp10--;
+        digit = true;
+      }
+    }
+    for (; CFG_IS_DIGIT(*p); p++) {
+      digit = true;
+      if (ndig < 19) {
+        man = man * 10 + (*p - '0');
+        ndig++;
+        exp10--;
+      }
+      else if (*p != '0') trunc = true;
+    }
+  }
+  if (!digit) return 0;
+
+  /* Exponent, which is only consumed if there are digits. */
+  if ((*p | 0x20) == 'e') {
+    const char *e = p + 1;
+    const bool eneg = (*e == '-');
+    if (*e == '-' || *e == '+') e++;
+    if (CFG_IS_DIGIT(*e)) {
+      int num = 0;
+      for (; CFG_IS_DIGIT(*e); e++) if (num < 100000) num = num * 10 + *e - '0';
+      exp10 += eneg ? -num : num;
+      p = e;
+    }
+  }
+
+  /* Clinger's fast path: both the significand and the power of 10 are exact
+     in the target type, so a single operation gives the correctly rounded
+     result, provided that there is no excess precision. */
+#if FLT_EVAL_METHOD == 0
+  if (trunc) return p - str;
+  if (man == 0) {
+    *var = neg ? -0.0 : 0.0;
+    *exact = true;
+  }
+  else if (flt) {
+    if ((man >> FLT_MANT_DIG) == 0 && exp10 >= -10 && exp10 <= 10) {
+      float val = (float) man;
+      if (exp10 >= 0) val *= (float) cfg_pow10[exp10];
+      else val /= (float) cfg_pow10[-exp10];
+      *var = neg ? -val : val;
+      *exact = true;
+    }
+  }
+  else if ((man >> DBL_MANT_DIG) == 0 && exp10 >= -22 && exp10 <= 22) {
+    double val = (double) man;
+    if (exp10 >= 0) val *= cfg_pow10[exp10];
+    else val /= cfg_pow10[-exp10];
+    *var = neg ? -val : val;
+    *exact = true;
+  }
+#else
+  (void) flt;
+  (void) trunc;
+#endif
+  return p - str;
+}
+
+/******************************************************************************
+Function `cfg_conv_fallback`:
+  Convert a scanned number with the C library, using '.' as the decimal
+  point regardless of the locale.
+Arguments:
+  * `str`:      the string containing the number;
+  * `len`:      number of characters of the number;
+  * `flt`:      true for single precision and false for double precision;
+  * `var`:      address of the variable for the converted value.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_conv_fallback(const char *str, const size_t len,
+    const bool flt, void *var) {
+  const char *point = localeconv()->decimal_point;
+  char tmp[CFG_STR_INIT_SIZE], *buf = tmp, *end;
+  size_t plen = 1;
+
+  /* Replace '.' by the decimal point of the current locale. */
+  if (point[0] != '.' || point[1] != '\0') {
+    plen = strlen(point);
+    if (len * plen >= CFG_STR_INIT_SIZE && !(buf = malloc(len * plen + 1)))
+      return CFG_ERR_MEMORY;
+    char *q = buf;
+    for (size_t i = 0; i < len; i++) {
+      if (str[i] == '.') {
+        memcpy(q, point, plen);
+        q += plen;
+      }
+      else *q++ = str[i];
+    }
+    *q = '\0';
+  }
+  else buf = (char *) str;
+
+  if (flt) *((float *) var) = strtof(buf, &end);
+  else *((double *) var) = strtod(buf, &end);
+  const bool ok = (end != buf);
+  if (buf != str && buf != tmp) free(buf);
+  return ok ? 0 : CFG_ERR_PARSE;
+}
+
+/******************************************************************************
+Function `cfg_conv_dbl`:
+  Convert the leading part of a string to a double precision number.
+Arguments:
+  * `str`:      the null terminated string;
+  * `var`:      address of the variable for the converted value.
+Return:
+  Number of characters converted; 0 on error.
+******************************************************************************/
+static size_t cfg_conv_dbl(const char *str, double *var) {
+  double val;
+  bool exact;
+  const size_t n = cfg_scan_real(str, false, &val, &exact);
+  if (!n) return 0;
+  if (exact) *var = val;
+  else if (cfg_conv_fallback(str, n, false, var)) return 0;
+  return n;
+}
+
+/******************************************************************************
+Function `cfg_conv_flt`:
+  Convert the leading part of a string to a single precision number.
+Arguments:
+  * `str`:      the null terminated string;
+  * `var`:      address of the variable for the converted value.
+Return:
+  Number of characters converted; 0 on error.
+******************************************************************************/
+static size_t cfg_conv_flt(const char *str, float *var) {
+  double val;
+  bool exact;
+  const size_t n = cfg_scan_real(str, true, &val, &exact);
+  if (!n) return 0;
+  if (exact) *var = (float) val;
+  else if (cfg_conv_fallback(str, n, true, var)) return 0;
+  return n;
+}
+
+
+/******************************************************************************
+Function `cfg_conv_number`:
+  Convert the leading part of a string to a number of the given type.
+Arguments:
+  * `str`:      the null terminated string;
+  * `dtype`:    data type of the number;
+  * `var`:      address of the variable for the converted value.
+Return:
+  Number of characters converted; 0 on error.
+******************************************************************************/
+static size_t cfg_conv_number(const char *str, const cfg_dtype_t dtype,
+    void *var) {
+  long lval;
+  size_t n;
+  switch (dtype) {
+    case CFG_DTYPE_INT:
+      if ((n = cfg_conv_long(str, INT_MIN, INT_MAX, &lval)))
+        *((int *) var) = lval;
+      return n;
+    case CFG_DTYPE_LONG:
+      return cfg_conv_long(str, LONG_MIN, LONG_MAX, (long *) var);
+    case CFG_DTYPE_FLT:
+      return cfg_conv_flt(str, (float *) var);
+    case CFG_DTYPE_DBL:
+      return cfg_conv_dbl(str, (double *) var);
+    default:
+      return 0;
+  }
+}
+
+/******************************************************************************
+Function `cfg_digit_run`:
+  Count the leading decimal digits of a string, up to 16 characters.
+Arguments:
+  * `str`:      the string with at least 16 readable characters.
+Return:
+  Number of leading digits; 16 if all the characters are digits.
+******************************************************************************/
+static inline int cfg_digit_run(const char *str) {
+#ifdef CFG_SIMD_X86
+  const __m128i v = _mm_loadu_si128((const __m128i *) str);
+  const int mask = _mm_movemask_epi8(_mm_and_si128(
+      _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1))));
+  return __builtin_ctz(~mask);                  /* bit 16 is always set */
+#else
+  int n = 0;
+  while (n < 16 && CFG_IS_DIGIT(str[n])) n++;
+  return n;
+#endif
+}
+
+/******************************************************************************
+Function `cfg_number_masks`:
+  Classify a block of characters for the bulk conversion of numbers.
+Arguments:
+  * `str`:      the string with at least `CFG_CONV_BLOCK_SIZE` characters;
+  * `sep`:      address for the bit mask of array separators;
+  * `digit`:    address for the bit mask of decimal digits;
+  * `point`:    address for the bit mask of decimal points.
+Return:
+  Bit mask of characters that are not expected in arrays of numbers, i.e.,
+  other than digits, signs, decimal points, exponent marks, and spaces.
+******************************************************************************/
+static inline uint64_t cfg_number_masks(const char *str, uint64_t *sep,
+    uint64_t *digit, uint64_t *point) {
+  uint64_t s = 0, d = 0, p = 0, ok = 0;
+#ifdef CFG_SIMD_X86
+  /* '+' ',' '-' '.' '/' and digits are in a continuous range. */
+  const __m128i lo = _mm_set1_epi8('+' - 1);
+  const __m128i hi = _mm_set1_epi8('9' + 1);
+  for (int i = 0; i < CFG_CONV_BLOCK_SIZE; i += 16) {
+    const __m128i v = _mm_loadu_si128((const __m128i *) (str + i));
+    const __m128i range = _mm_andnot_si128(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('/')),
+        _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi)));
+    const __m128i valid = _mm_or_si128(range, _mm_or_si128(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+        _mm_cmpeq_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)),
+        _mm_set1_epi8('e'))));
+    s |= (uint64_t) (unsigned) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8(CFG_SYM_ARRAY_SEP))) << i;
+    d |= (uint64_t) (unsigned) _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, hi))) << i;
+    p |= (uint64_t) (unsigned) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))) << i;
+    ok |= (uint64_t) (unsigned) _mm_movemask_epi8(valid) << i;
+  }
+#else
+  for (int i = 0; i < CFG_CONV_BLOCK_SIZE; i++) {
+    const char c = str[i];
+    s |= (uint64_t) (c == CFG_SYM_ARRAY_SEP) << i;
+    d |= (uint64_t) CFG_IS_DIGIT(c) << i;
+    p |= (uint64_t) (c == '.') << i;
+    ok |= (uint64_t) (CFG_IS_DIGIT(c) || c == '+' || c == '-' || c == '.' ||
+        c == ' ' || c == CFG_SYM_ARRAY_SEP || (c | 0x20) == 'e') << i;
+  }
+#endif
+  *sep = s;
+  *digit = d;
+  *point = p;
+  return ~ok;
+}
+
+/******************************************************************************
+Function `cfg_trailing_zeros`:
+  Count the trailing zero bits of a non-zero 64-bit integer.
+Arguments:
+  * `x`:        the integer.
+Return:
+  Index of the lowest set bit.
+******************************************************************************/
+static inline int cfg_trailing_zeros(uint64_t x) {
+#ifdef __GNUC__
+  return __builtin_ctzll(x);
+#else
+  int n = 0;
+  for (; !(x & 1); x >>= 1) n++;
+  return n;
+#endif
+}
+
+/******************************************************************************
+Function `cfg_digits_value`:
+  Accumulate a run of decimal digits to an unsigned integer.
+Arguments:
+  * `num`:      the initial value;
+  * `str`:      the digits, followed by at least 8 readable characters;
+  * `n`:        number of digits, for which the result must not overflow.
+Return:
+  The initial value followed by the digits.
+******************************************************************************/
+static inline uint64_t cfg_digits_value(uint64_t num, const char *str,
+    int n) {
+#ifdef CFG_SWAR_DIGITS
+  /* Powers of 10 for appending partial groups. */
+  static const uint64_t scale[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+  };
+  while (n > 0) {
+    const int k = (n < 8) ? n : 8;
+    uint64_t v;
+    memcpy(&v, str, 8);
+    /* Drop the characters after the digits, and pad with leading zeros. */
+    v = (v << (8 * (8 - k))) & 0x0F0F0F0F0F0F0F0FULL;
+    v = (v * 2561) >> 8;
+    v = ((v & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    v = ((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+    num = num * scale[k] + v;
+    str += k;
+    n -= k;
+  }
+#else
+  for (int i = 0; i < n; i++) num = num * 10 + (str[i] - '0');
+#endif
+  return num;
+}
+
+/******************************************************************************
+Function `cfg_conv_digits`:
+  Compute a number from the runs of digits before and after the decimal
+  point, if it is exactly representable.  The results are identical to those
+  of `cfg_conv_number`.
+Arguments:
+  * `str`:      the digits, followed by at least 8 readable characters;
+  * `nint`:     number of digits before the decimal point;
+  * `nfrac`:    number of digits after the decimal point, negative if there
+                is no decimal point;
+  * `neg`:      true if the number is negative;
+  * `dtype`:    data type of the number;
+  * `var`:      address of the variable for the converted value.
+Return:
+  True if the number is converted; false otherwise.
+******************************************************************************/
+static inline bool cfg_conv_digits(const char *str, const int nint,
+    const int nfrac, const bool neg, const cfg_dtype_t dtype, void *var) {
+  if (dtype == CFG_DTYPE_INT) {
+    if (nfrac >= 0 || nint > CFG_CONV_INT_DIGITS) return false;
+    const int val = (int) cfg_digits_value(0, str, nint);
+    *((int *) var) = neg ? -val : val;
+    return true;
+  }
+  if (dtype == CFG_DTYPE_LONG) {
+    if (nfrac >= 0 || nint > CFG_CONV_LONG_DIGITS) return false;
+    const long val = (long) cfg_digits_value(0, str, nint);
+    *((long *) var) = neg ? -val : val;
+    return true;
+  }
+#if FLT_EVAL_METHOD == 0
+  /* Same operations as the fast path of `cfg_scan_real`. */
+  const int nf = (nfrac < 0) ? 0 : nfrac;
+  if (nint + nf > 19) return false;
+  const uint64_t man =
+      cfg_digits_value(cfg_digits_value(0, str, nint), str + nint + 1, nf);
+  if (dtype == CFG_DTYPE_FLT) {
+    if ((man >> FLT_MANT_DIG) != 0 || nf > 10) return false;
+    const float val = (float) man / (float) cfg_pow10[nf];
+    *((float *) var) = neg ? -val : val;
+    return true;
+  }
+  if (dtype == CFG_DTYPE_DBL) {
+    if ((man >> DBL_MANT_DIG) != 0 || nf > 22) return false;
+    const double val = (double) man / cfg_pow10[nf];
+    *((double *) var) = neg ? -val : val;
+    return true;
+  }
+#endif
+  return false;
+}
+
+/******************************************************************************
+Function `cfg_conv_simple`:
+  Convert a number in the common form, i.e., an optional sign, a run of
+  digits, and optionally a decimal point and another run of digits for
+  floating-point numbers, if it is exactly representable.
+Arguments:
+  * `str`:      the string with at least `CFG_CONV_BULK_SIZE` readable
+                characters;
+  * `dtype`:    data type of the number;
+  * `var`:      address of the variable for the converted value.
+Return:
+  Number of characters converted; 0 if the number is not in the common form.
+******************************************************************************/
+static size_t cfg_conv_simple(const char *str, const cfg_dtype_t dtype,
+    void *var) {
+  const bool neg = (*str == '-');
+  const char *p = str + (neg || *str == '+');
+  const int nint = cfg_digit_run(p);
+  if (!nint || nint == 16) return 0;
+  const char *q = p + nint;
+  int nfrac = -1;
+  if (*q == '.' && (dtype == CFG_DTYPE_FLT || dtype == CFG_DTYPE_DBL)) {
+    if ((nfrac = cfg_digit_run(++q)) == 16) return 0;
+    q += nfrac;
+  }
+  /* Leave numbers with other suffixes to the scalar converter. */
+  if (*q != ' ' && *q != CFG_SYM_ARRAY_SEP && *q != CFG_SYM_ARRAY_END)
+    return 0;
+  return cfg_conv_digits(p, nint, nfrac, neg, dtype, var) ? q - str : 0;
+}
+
+
+/*============================================================================*\
+          Functions for parsing configurations represented by strings
+\*============================================================================*/
+
+/* Character classes of all the characters, for the string parser. */
+static const unsigned char cfg_char_class[UCHAR_MAX + 1] = {
+  CFG_CHAR_CLASS64(0), CFG_CHAR_CLASS64(64),
+  CFG_CHAR_CLASS64(128), CFG_CHAR_CLASS64(192)
+};
+
+/* State transition table of the string parser, indexed by the current state
+ * and the class of the input character.  Unlisted transitions are errors. */
+#define CFG_TRANS(s, a)         {CFG_PARSE_##s, CFG_ACT_##a}
+static const cfg_parse_trans_t
+    cfg_parse_trans[CFG_PARSE_NUM_STATES][CFG_CHAR_NUM_CLASSES] = {
+  [CFG_PARSE_START] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(START, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(START, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(KEYWORD, KEY),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(START, PASS)
+  },
+  [CFG_PARSE_KEYWORD] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(EQUAL, KEY_END),
+    [CFG_CHAR_SPACE] = CFG_TRANS(EQUAL, KEY_END),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(KEYWORD, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(KEYWORD, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(VALUE_START, KEY_END)
+  },
+  [CFG_PARSE_EQUAL] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(EQUAL, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(EQUAL, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(VALUE_START, NONE)
+  },
+  [CFG_PARSE_VALUE_START] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(VALUE_START, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(VALUE_START, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(VALUE, VALUE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(VALUE, VALUE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(VALUE, VALUE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(DQUOTE, VALUE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(SQUOTE, VALUE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(ARRAY_START, VALUE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(VALUE, VALUE),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(VALUE, VALUE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(VALUE_START, PASS),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(VALUE, VALUE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(VALUE, VALUE)
+  },
+  [CFG_PARSE_VALUE] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(VALUE, DONE),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(VALUE, NONE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(VALUE, NONE)
+  },
+  [CFG_PARSE_DQUOTE] = {
+    [CFG_CHAR_OTHER] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_BLANK] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(QUOTE_END, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(DQUOTE, NONE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(DQUOTE, NONE)
+  },
+  [CFG_PARSE_SQUOTE] = {
+    [CFG_CHAR_OTHER] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_BLANK] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(QUOTE_END, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(SQUOTE, NONE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(SQUOTE, NONE)
+  },
+  [CFG_PARSE_QUOTE_END] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(QUOTE_END, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(QUOTE_END, NONE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(QUOTE_END, DONE)
+  },
+  [CFG_PARSE_ARRAY_START] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_START, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(ARRAY_START, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(ARRAY_NEWLINE, NEWLINE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(ARRAY_VALUE, NONE)
+  },
+  [CFG_PARSE_ARRAY_VALUE] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(ARRAY_START, SEP),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(ARRAY_END, END),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(ARRAY_VALUE, NONE)
+  },
+  [CFG_PARSE_ARRAY_DQUOTE] = {
+    [CFG_CHAR_OTHER] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(ARRAY_QUOTE_END, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(ARRAY_DQUOTE, NONE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(ARRAY_DQUOTE, NONE)
+  },
+  [CFG_PARSE_ARRAY_SQUOTE] = {
+    [CFG_CHAR_OTHER] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(ARRAY_QUOTE_END, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(ARRAY_SQUOTE, NONE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(ARRAY_SQUOTE, NONE)
+  },
+  [CFG_PARSE_ARRAY_QUOTE_END] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_QUOTE_END, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(ARRAY_QUOTE_END, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(ARRAY_START, SEP),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(ARRAY_END, END)
+  },
+  /* Line continuation is confirmed by whitespaces or comments; otherwise
+   * CFG_SYM_NEWLINE is simply part of an array element. */
+  [CFG_PARSE_ARRAY_NEWLINE] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_NEWLINE, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(ARRAY_NEWLINE, NONE),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(ARRAY_START, SEP),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(ARRAY_END, END),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(ARRAY_VALUE, NONE),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(ARRAY_VALUE, NONE)
+  },
+  [CFG_PARSE_CLEAN] = {
+    [CFG_CHAR_OTHER] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_BLANK] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_SPACE] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_ALPHA] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_DIGIT] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_EQUAL] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_DQUOTE] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_SQUOTE] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_ARRAY_START] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_NEWLINE] = CFG_TRANS(CLEAN, CLEAN),
+    [CFG_CHAR_GRAPH] = CFG_TRANS(CLEAN, CLEAN)
+  },
+  [CFG_PARSE_ARRAY_END] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_END, NONE),
+    [CFG_CHAR_SPACE] = CFG_TRANS(ARRAY_END, NONE),
+    [CFG_CHAR_COMMENT] = CFG_TRANS(ARRAY_END, DONE)
+  },
+  /* Only used by the array parser, after converting a number. */
+  [CFG_PARSE_ARRAY_NUMBER_END] = {
+    [CFG_CHAR_BLANK] = CFG_TRANS(ARRAY_NUMBER_END, NONE),
+    [CFG_CHAR_ARRAY_SEP] = CFG_TRANS(ARRAY_START, SEP),
+    [CFG_CHAR_ARRAY_END] = CFG_TRANS(ARRAY_END, END)
+  }
+};
+#undef CFG_TRANS
+
+/* Quotation marks to be searched for directly in quoted states. */
+static const char cfg_parse_quote[CFG_PARSE_NUM_STATES] = {
+  [CFG_PARSE_DQUOTE] = '"',             [CFG_PARSE_SQUOTE] = '\'',
+  [CFG_PARSE_ARRAY_DQUOTE] = '"',       [CFG_PARSE_ARRAY_SQUOTE] = '\''
+};
+
+/******************************************************************************
+Function `cfg_parse_line`:
+  Read the configuration from a line of a configration file.
+Arguments:
+  * `line`:     the null terminated string line;
+  * `len`:      length of the line, NOT including the first '\0';
+  * `key`:      address of the retrieved keyword;
+  * `value`:    address of the retrieved value;
+  * `state`:    initial state for the parser.
+Return:
+  Parser status.
+******************************************************************************/
+static cfg_parse_return_t cfg_parse_line(char *line, const size_t len,
+    char **key, char **value, cfg_parse_state_t state) {
+  if (!line || *line == '\0' || len == 0) return CFG_PARSE_PASS;
+  char *newline = NULL;         /* handle line continuation */
+  for (size_t i = 0; i < len; i++) {
+    /* Skip characters that do not change the state in bulk. */
+    if (state == CFG_PARSE_VALUE) {
+      i += cfg_scan_special(line + i, len - i, CFG_SYM_COMMENT,
+          CFG_SYM_COMMENT, CFG_SYM_COMMENT);
+      if (i == len) break;
+    }
+    else if (state == CFG_PARSE_ARRAY_VALUE) {
+      i += cfg_scan_special(line + i, len - i, CFG_SYM_ARRAY_SEP,
+          CFG_SYM_ARRAY_END, CFG_SYM_COMMENT);
+      if (i == len) break;
+    }
+    else if (cfg_parse_quote[state]) {
+      const char *q = memchr(line + i, cfg_parse_quote[state], len - i);
+      if (!q) break;
+      i = q - line;
+    }
+    else if (state == CFG_PARSE_CLEAN) {
+      memset(line + i, ' ', len - i);
+      break;
+    }
+
+    const cfg_parse_trans_t t =
+      cfg_parse_trans[state][cfg_char_class[(unsigned char) line[i]]];
+    state = t.state;
+    switch (t.action) {
+      case CFG_ACT_NONE:
+      case CFG_ACT_SEP:
+      case CFG_ACT_END:
+        break;
+      case CFG_ACT_KEY:
+        *key = line + i;
+        break;
+      case CFG_ACT_KEY_END:
+        /* check if the keyword is too long */
+        if (line + i - *key >= CFG_MAX_NAME_LEN) return CFG_PARSE_ERROR;
+        line[i] = '\0';                         /* terminate the keyword */
+        break;
+      case CFG_ACT_VALUE:
+        *value = line + i;
+        break;
+      case CFG_ACT_NEWLINE:
+        newline = line + i;
+        break;
+      case CFG_ACT_CLEAN:                       /* clear all characters */
+        line[i] = ' ';
+        break;
+      case CFG_ACT_DONE:
+        line[i] = '\0';                         /* terminate the value */
+        return CFG_PARSE_DONE;
+      case CFG_ACT_PASS:
+        return CFG_PARSE_PASS;
+      default:
+        return CFG_PARSE_ERROR;
+    }
+  }
+
+  /* Check the final status. */
+  switch (state) {
+    case CFG_PARSE_VALUE:
+    case CFG_PARSE_QUOTE_END:
+    case CFG_PARSE_ARRAY_END:
+      return CFG_PARSE_DONE;
+    case CFG_PARSE_START:
+    case CFG_PARSE_VALUE_START:
+      return CFG_PARSE_PASS;
+    case CFG_PARSE_ARRAY_NEWLINE:
+    case CFG_PARSE_CLEAN:
+      *newline = ' ';
+      return CFG_PARSE_CONTINUE;
+    default:
+      return CFG_PARSE_ERROR;
+  }
+}
+
+/******************************************************************************
+Function `cfg_get_value`:
+  Retrieve the parameter value and assign it to a variable.
+Arguments:
+  * `var`:      pointer to the variable to be assigned value; for strings,
+                the variable is set to point to `str` if it is NULL;
+  * `str`:      string storing the parameter value;
+  * `size`:     length of `value`, including the ending '\0';
+  * `dtype`:    data type;
+  * `src`:      source of this value.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_get_value(void *var, char *str, const size_t size,
+    const cfg_dtype_t dtype, int src) {
+  if (!str || !size) return 0;
+  char *value = str;
+  size_t n;
+
+  /* Validate the value. */
+  while (*value && isspace(*value)) value++;          /* omit whitespaces */
+  if (*value == '\0') return CFG_ERR_VALUE;           /* empty string */
+  if (*value == '"' || *value == '\'') {              /* remove quotes */
+    char quote = *value;
+    value++;
+    for (n = 0; value[n]; n++) {      /* the string is surely terminated */
+      if (value[n] == quote) {
         value[n] = '\0';
         quote = 0;    /* a flag indicating the other quote is found */
         break;
@@ -789,34 +2689,22 @@ static int cfg_get_value(void *var, char *str, const size_t size,
   n = 0;
   switch (dtype) {
     case CFG_DTYPE_BOOL:
-      if (!strncmp(value, "1", 2) || !strncmp(value, "T", 2) ||
-          !strncmp(value, "t", 2) || !strncmp(value, "true", 5) ||
-          !strncmp(value, "TRUE", 5) || !strncmp(value, "True", 5))
-        *((bool *) var) = true;
-      else if (!strncmp(value, "0", 2) || !strncmp(value, "F", 2) ||
-          !strncmp(value, "f", 2) || !strncmp(value, "false", 6) ||
-          !strncmp(value, "FALSE", 6) || !strncmp(value, "False", 6))
-        *((bool *) var) = false;
-      else return CFG_ERR_PARSE;
+      if (cfg_conv_bool(value, (bool *) var)) return CFG_ERR_PARSE;
       break;
     case CFG_DTYPE_CHAR:
       *((char *) var) = *value;
       n = 1;
       break;
     case CFG_DTYPE_INT:
-      if (sscanf(value, "%d%n", (int *) var, &n) != 1) return CFG_ERR_PARSE;
-      break;
     case CFG_DTYPE_LONG:
-      if (sscanf(value, "%ld%n", (long *) var, &n) != 1) return CFG_ERR_PARSE;
-      break;
     case CFG_DTYPE_FLT:
-      if (sscanf(value, "%f%n", (float *) var, &n) != 1) return CFG_ERR_PARSE;
-      break;
     case CFG_DTYPE_DBL:
-      if (sscanf(value, "%lf%n", (double *) var, &n) != 1) return CFG_ERR_PARSE;
+      if (!(n = cfg_conv_number(value, dtype, var))) return CFG_ERR_PARSE;
       break;
     case CFG_DTYPE_STR:
-      strcpy(*((char **) var), value);  /* the usage of strcpy is safe here */
+      if (*((char **) var))     /* the usage of strcpy is safe here */
+        strcpy(*((char **) var), value);
+      else *((char **) var) = value;    /* point to the kept source */
       break;
     default:
       return CFG_ERR_DTYPE;
@@ -834,137 +2722,442 @@ static int cfg_get_value(void *var, char *str, const size_t size,
 }
 
 /******************************************************************************
-Function `cfg_get_array`:
-  Retrieve the parameter values and assign them to an array.
+Function `cfg_conv_numbers`:
+  Convert consecutive elements of a numeric array in bulk, without going
+  through the parser states.  Separators, digits, and decimal points are
+  located in blocks with SIMD instructions, so that the elements in the
+  common form are converted directly from the bit masks, independently of
+  each other.  The other elements are converted by `cfg_conv_simple` or
+  `cfg_conv_number`.  It stops at the first block with characters that are
+  not expected in numbers, or at the first invalid element.
 Arguments:
-  * `par`:      address of the verified configuration parameter;
-  * `src`:      source of the value.
+  * `str`:      the null terminated string starting with an element;
+  * `len`:      number of characters of the string;
+  * `dtype`:    data type of the elements;
+  * `size`:     size of each element;
+  * `var`:      address for the converted values;
+  * `num`:      maximum number of elements to be converted;
+  * `cnt`:      address for the number of converted elements.
 Return:
-  Zero on success; non-zero on error.
+  Number of characters processed, ending with the last separator.
 ******************************************************************************/
-static int cfg_get_array(cfg_param_valid_t *par, int src) {
-  size_t len;
-  int i, err;
-
-  /* Split the value string for array elements. */
-  if ((err = cfg_parse_array(par))) return err;
-  char *value = par->value;   /* array elements are separated by '\0' */
-
-  /* Allocate memory and assign values for arrays. */
-  switch (par->dtype) {
-    case CFG_ARRAY_BOOL:
-      *((bool **) par->var) = calloc(par->narr, sizeof(bool));
-      if (!(*((bool **) par->var))) return CFG_ERR_MEMORY;
-      /* call the value assignment function for each segment */
-      for (i = 0; i < par->narr; i++) {
-        len = strlen(value) + 1;      /* strlen is safe here */
-        if ((err = cfg_get_value(*((bool **) par->var) + i, value, len,
-            CFG_DTYPE_BOOL, src))) return err;
-        value += len;
-      }
-      break;
-    case CFG_ARRAY_CHAR:
-      *((char **) par->var) = calloc(par->narr, sizeof(char));
-      if (!(*((char **) par->var))) return CFG_ERR_MEMORY;
-      for (i = 0; i < par->narr; i++) {
-        len = strlen(value) + 1;
-        if ((err = cfg_get_value(*((char **) par->var) + i, value, len,
-            CFG_DTYPE_CHAR, src))) return err;
-        value += len;
-      }
-      break;
-    case CFG_ARRAY_INT:
-      *((int **) par->var) = calloc(par->narr, sizeof(int));
-      if (!(*((int **) par->var))) return CFG_ERR_MEMORY;
-      for (i = 0; i < par->narr; i++) {
-        len = strlen(value) + 1;
-        if ((err = cfg_get_value(*((int **) par->var) + i, value, len,
-            CFG_DTYPE_INT, src))) return err;
-        value += len;
-      }
-      break;
-    case CFG_ARRAY_LONG:
-      *((long **) par->var) = calloc(par->narr, sizeof(long));
-      if (!(*((long **) par->var))) return CFG_ERR_MEMORY;
-      for (i = 0; i < par->narr; i++) {
-        len = strlen(value) + 1;
-        if ((err = cfg_get_value(*((long **) par->var) + i, value, len,
-            CFG_DTYPE_LONG, src))) return err;
-        value += len;
-      }
-      break;
-    case CFG_ARRAY_FLT:
-      *((float **) par->var) = calloc(par->narr, sizeof(float));
-      if (!(*((float **) par->var))) return CFG_ERR_MEMORY;
-      for (i = 0; i < par->narr; i++) {
-        len = strlen(value) + 1;
-        if ((err = cfg_get_value(*((float **) par->var) + i, value, len,
-            CFG_DTYPE_FLT, src))) return err;
-        value += len;
-      }
-      break;
-    case CFG_ARRAY_DBL:
-      *((double **) par->var) = calloc(par->narr, sizeof(double));
-      if (!(*((double **) par->var))) return CFG_ERR_MEMORY;
-      for (i = 0; i < par->narr; i++) {
-        len = strlen(value) + 1;
-        if ((err = cfg_get_value(*((double **) par->var) + i, value, len,
-            CFG_DTYPE_DBL, src))) return err;
-        value += len;
+static size_t cfg_conv_numbers(const char *str, const size_t len,
+    const cfg_dtype_t dtype, const size_t size, void *var, const size_t num,
+    size_t *cnt) {
+  size_t n = 0, pos = 0;                /* `pos` is after the last separator */
+  /* Every block starts with an element, which is then inside the block. */
+  while (pos + CFG_CONV_BLOCK_SIZE + CFG_CONV_BULK_SIZE <= len) {
+    const char *blk = str + pos;
+    uint64_t sep, digit, point;
+    const uint64_t other = cfg_number_masks(blk, &sep, &digit, &point);
+    if (other) sep &= ((uint64_t) 1 << cfg_trailing_zeros(other)) - 1;
+    if (!sep) break;
+
+    for (; sep; sep &= sep - 1) {
+      const char *p = str + pos, *end = blk + cfg_trailing_zeros(sep);
+      const char *e = end;
+      char *v = (char *) var + n * size;
+      while (*p == ' ') p++;
+      while (e > p && e[-1] == ' ') e--;
+
+      /* Check the digits with the masks, and compute the value directly. */
+      const bool neg = (*p == '-');
+      const int off = p - blk + (neg || *p == '+');
+      const int l = e - blk - off;
+      bool conv = false;
+      if (l > 0) {
+        const uint64_t all = ((uint64_t) 1 << l) - 1;
+        const uint64_t pt = (point >> off) & all;
+        if ((((digit >> off) & all) | pt) == all && !(pt & (pt - 1))) {
+          const int nint = pt ? cfg_trailing_zeros(pt) : l;
+          conv = nint && cfg_conv_digits(blk + off, nint,
+              pt ? l - nint - 1 : -1, neg, dtype, v);
+        }
       }
-      break;
-    case CFG_ARRAY_STR:
-      *((char ***) par->var) = calloc(par->narr, sizeof(char *));
-      if (!(*((char ***) par->var))) return CFG_ERR_MEMORY;
-      /* Allocate enough memory for the first element of the string array. */
-      *(*((char ***) par->var)) = calloc(par->vlen, sizeof(char));
-      char *tmp = *(*((char ***) par->var));
-      if (!tmp) return CFG_ERR_MEMORY;
-      /* The rest elements point to different positions of the space. */
-      for (i = 0; i < par->narr; i++) {
-        (*((char ***) par->var))[i] = tmp;
-        len = strlen(value) + 1;
-        if ((err = cfg_get_value(&tmp, value, len, CFG_DTYPE_STR, src)))
-          return err;
-        tmp += strlen(tmp) + 1;       /* null termination ensured by calloc */
-        value += len;
+
+      if (!conv) {
+        size_t k = cfg_conv_simple(p, dtype, v);
+        if (!k && !(k = cfg_conv_number(p, dtype, v))) goto done;
+        for (p += k; *p == ' '; p++);
+        if (p != end) goto done;
       }
-      break;
-    default:
-      return CFG_ERR_DTYPE;             /* is CFG_DTYPE_IS_ARRAY correct? */
+      pos = end + 1 - str;
+      if (++n == num) goto done;
+    }
+    if (other) break;
   }
-  return 0;
+done:
+  *cnt = n;
+  return pos;
 }
 
+#ifdef CFG_ENABLE_THREADS
 /******************************************************************************
-Function `cfg_get`:
-  Retrieve the parameter value and assign it to a variable.
+Function `cfg_count_piece`:
+  Count the separators in a piece of a numerical array, which is the number
+  of elements if the piece ends with a separator.
 Arguments:
-  * `cfg`:      entry for all configurations;
-  * `par`:      address of the verified configuration parameter;
-  * `src`:      source of the value;
+  * `arg`:      the piece of the array.
 Return:
-  Zero on success; non-zero on error.
+  NULL.
 ******************************************************************************/
-static int cfg_get(cfg_t *cfg, cfg_param_valid_t *par, int src) {
-  int err = 0;
-  /* Validate function arguments. */
-  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
-  if (!par->value || *par->value == '\0') return 0;     /* value not set */
+static void *cfg_count_piece(void *arg) {
+  cfg_array_piece_t *piece = (cfg_array_piece_t *) arg;
+  const char *p = piece->str, *end = piece->str + piece->end;
+  size_t num = 0;
+  while ((p = memchr(p, CFG_SYM_ARRAY_SEP, end - p))) {
+    num++;
+    if (++p == end) break;
+  }
+  piece->num = num;
+  return NULL;
+}
 
-  /* Deal with arrays and scalars separately. */
-  if (CFG_DTYPE_IS_ARRAY(par->dtype))   /* force preprocessing the value */
-    err = cfg_get_array(par, src);
-  else {
-    /* Allocate memory only for string. */
-    if (par->dtype == CFG_DTYPE_STR) {
-      *((char **) par->var) = calloc(par->vlen, sizeof(char));
-      if (!(*((char **) par->var))) err = CFG_ERR_MEMORY;
-    }
+/******************************************************************************
+Function `cfg_conv_piece`:
+  Convert all the elements of a piece of a numerical array in bulk.
+Arguments:
+  * `arg`:      the piece of the array.
+Return:
+  NULL.
+******************************************************************************/
+static void *cfg_conv_piece(void *arg) {
+  cfg_array_piece_t *piece = (cfg_array_piece_t *) arg;
+  size_t cnt;
+  const size_t pos = cfg_conv_numbers(piece->str, piece->len, piece->dtype,
+      piece->size, piece->var, piece->num, &cnt);
+  piece->ok = (cnt == piece->num && pos == piece->end);
+  return NULL;
+}
 
-    /* Assign values to the variable.  */
-    if (!err)
-      err = cfg_get_value(par->var, par->value, par->vlen, par->dtype, src);
+/******************************************************************************
+Function `cfg_run_threads`:
+  Process tasks with one thread each, the first of which is the calling
+  thread.  Tasks are processed by the calling thread as well if new threads
+  cannot be created.
+Arguments:
+  * `func`:     the function for processing a task;
+  * `task`:     array of the tasks;
+  * `size`:     size of each task;
+  * `num`:      number of tasks;
+  * `alloc`:    the allocation functions.
+******************************************************************************/
+static void cfg_run_threads(void *(*func) (void *), void *task,
+    const size_t size, const int num, const cfg_allocator_t *alloc) {
+  pthread_t *tid = cfg_malloc(alloc, num * sizeof(pthread_t));
+  bool *run = cfg_calloc(alloc, num, sizeof(bool));
+  for (int i = 1; i < num; i++) {
+    if (tid && run &&
+        !pthread_create(tid + i, NULL, func, (char *) task + i * size))
+      run[i] = true;
+  }
+  func(task);
+  for (int i = 1; i < num; i++) {
+    if (run && run[i]) pthread_join(tid[i], NULL);
+    else func((char *) task + i * size);
+  }
+  if (tid) cfg_free(alloc, tid);
+  if (run) cfg_free(alloc, run);
+}
+
+/******************************************************************************
+Function `cfg_conv_parallel`:
+  Split the leading part of a large numerical array at separators, and
+  convert the pieces with multiple threads, each writing to its own slice of
+  the values.  The last few elements are left to the caller.
+Arguments:
+  * `str`:      the null terminated string starting with the first element;
+  * `len`:      number of characters of the string;
+  * `nthread`:  maximum number of threads;
+  * `dtype`:    data type of the elements;
+  * `size`:     size of each element;
+  * `val`:      address of the buffer for the values, which is enlarged if
+                necessary;
+  * `cap`:      address of the capacity of the buffer;
+  * `cnt`:      address for the number of converted elements;
+  * `alloc`:    the allocation functions.
+Return:
+  Number of characters processed, ending with a separator; 0 if the array
+  cannot be converted in pieces, for which the serial parser is needed.
+******************************************************************************/
+static size_t cfg_conv_parallel(const char *str, const size_t len,
+    int nthread, const cfg_dtype_t dtype, const size_t size, char **val,
+    size_t *cap, size_t *cnt, const cfg_allocator_t *alloc) {
+  *cnt = 0;
+  if (len <= CFG_THREAD_TAIL_SIZE) return 0;
+  const size_t span = len - CFG_THREAD_TAIL_SIZE;
+  if ((size_t) nthread > span / CFG_THREAD_MIN_SIZE)
+    nthread = span / CFG_THREAD_MIN_SIZE;
+  if (nthread < 2) return 0;
+  cfg_array_piece_t *piece =
+    cfg_calloc(alloc, nthread, sizeof(cfg_array_piece_t));
+  if (!piece) return 0;
+
+  /* Split the array right after the first separators of even intervals. */
+  size_t start = 0;
+  int num = 0;
+  for (int i = 1; i <= nthread; i++) {
+    const size_t pos = span / nthread * i;
+    if (pos < start) continue;
+    const char *sep = memchr(str + pos, CFG_SYM_ARRAY_SEP, len - pos);
+    if (!sep) break;
+    const size_t end = sep + 1 - str;
+    if (end + CFG_CONV_BLOCK_SIZE + CFG_CONV_BULK_SIZE > len) break;
+    piece[num].str = str + start;
+    piece[num].len = len - start;
+    piece[num].end = end - start;
+    piece[num].dtype = dtype;
+    piece[num].size = size;
+    num++;
+    start = end;
+  }
+  if (num < 2) {
+    cfg_free(alloc, piece);
+    return 0;
+  }
+
+  /* Count the elements, and find the slices of the values. */
+  cfg_run_threads(cfg_count_piece, piece, sizeof(cfg_array_piece_t), num,
+      alloc);
+  size_t total = 0;
+  for (int i = 0; i < num; i++) total += piece[i].num;
+  if (total >= *cap) {
+    char *ext = cfg_realloc(alloc, *val, (total + CFG_ARRAY_INIT_SIZE) * size);
+    if (!ext) {
+      cfg_free(alloc, piece);
+      return 0;
+    }
+    *val = ext;
+    *cap = total + CFG_ARRAY_INIT_SIZE;
+  }
+  total = 0;
+  for (int i = 0; i < num; i++) {
+    piece[i].var = *val + total * size;
+    total += piece[i].num;
+  }
+
+  /* The pieces are valid only if all the separators are consumed. */
+  cfg_run_threads(cfg_conv_piece, piece, sizeof(cfg_array_piece_t), num,
+      alloc);
+  for (int i = 0; i < num; i++) {
+    if (!piece[i].ok) {
+      cfg_free(alloc, piece);
+      return 0;
+    }
+  }
+  cfg_free(alloc, piece);
+  *cnt = total;
+  return start;
+}
+#endif
+
+/******************************************************************************
+Function `cfg_get_array`:
+  Retrieve the parameter values and assign them to an array, by splitting and
+  converting the elements in a single pass.  Numbers are converted as soon as
+  they are found, and the other elements are converted when separators are
+  found.  The values are stored in a buffer that grows geometrically.
+Arguments:
+  * `cfg`:      entry for all configurations;
+  * `par`:      address of the verified configuration parameter;
+  * `src`:      source of the value.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_get_array(cfg_t *cfg, cfg_param_valid_t *par, int src) {
+  par->narr = 0;                /* no need to check whether `par` is NULL */
+  if (!par->value || !par->vlen) return 0;              /* empty string */
+
+  const cfg_dtype_t dtype = CFG_DTYPE_OF_ARRAY(par->dtype);
+  const size_t size = cfg_dtype_size(dtype);
+  if (!size) return CFG_ERR_DTYPE;
+  const bool number = (dtype >= CFG_DTYPE_INT && dtype <= CFG_DTYPE_DBL);
+
+  /* The last character of the value is always '\0'. */
+  char *value = par->value;
+  const size_t len = par->vlen - 1;
+  size_t i = 0;
+  while (i < len && CFG_IS_SPACE(value[i])) i++;
+  const bool array = (i < len && value[i] == CFG_SYM_ARRAY_START);
+
+  /* Buffers for the values, and for strings that are not kept in place. */
+  size_t cap = array ? CFG_ARRAY_INIT_SIZE : 1;
+  char *val = cfg_malloc(cfg->alloc, cap * size);
+  char *str = NULL, *tmp = NULL;
+  if (dtype == CFG_DTYPE_STR && !cfg->source)
+    tmp = str = cfg_calloc(cfg->alloc, par->vlen, sizeof(char));
+  if (!val || (dtype == CFG_DTYPE_STR && !cfg->source && !str)) {
+    if (val) cfg_free(cfg->alloc, val);
+    return CFG_ERR_MEMORY;
+  }
+  CFG_STAT_ADD(cfg, nalloc[par->dtype], str ? 2 : 1);
+  CFG_STAT_ADD(cfg, salloc[par->dtype], cap * size + (str ? par->vlen : 0));
+
+  size_t n = 0;
+  int err = 0;
+  if (!array) {                 /* try to parse as a single variable */
+    if (dtype == CFG_DTYPE_STR) *((char **) val) = tmp;
+    err = cfg_get_value(val, value, par->vlen, dtype, src);
+    if (tmp) tmp += strlen(tmp) + 1;
+    n = 1;
+  }
+  else {
+    cfg_parse_state_t state = CFG_PARSE_ARRAY_START;
+#ifdef CFG_ENABLE_THREADS
+    /* Convert most elements of large numerical arrays with threads. */
+    if (number && cfg->nthread > 1)
+      i += cfg_conv_parallel(value + i + 1, len - i - 1, cfg->nthread, dtype,
+          size, &val, &cap, &n, cfg->alloc);
+#endif
+    char *start = value + i + 1;        /* starting point of the element */
+    bool done = false;                  /* true if element is converted */
+
+    for (i++; i < len && !err; i++) {
+      /* Skip characters that do not change the state in bulk. */
+      if (state == CFG_PARSE_ARRAY_VALUE) {
+        i += cfg_scan_special(value + i, len - i, CFG_SYM_ARRAY_SEP,
+            CFG_SYM_ARRAY_END, CFG_SYM_COMMENT);
+        if (i == len) break;
+      }
+      else if (cfg_parse_quote[state]) {
+        const char *q = memchr(value + i, cfg_parse_quote[state], len - i);
+        if (!q) break;
+        i = q - value;
+      }
+
+      /* Reserve space for the next element. */
+      if (n == cap) {
+        char *ext = NULL;
+        if ((cap = cfg_grow_size(cap, n + 1, size)))
+          ext = cfg_realloc(cfg->alloc, val, cap * size);
+        if (!ext) {
+          err = CFG_ERR_MEMORY;
+          break;
+        }
+        val = ext;
+        CFG_STAT_ADD(cfg, nalloc[par->dtype], 1);
+        CFG_STAT_ADD(cfg, salloc[par->dtype], cap * size);
+      }
+
+      const cfg_parse_trans_t t =
+        cfg_parse_trans[state][cfg_char_class[(unsigned char) value[i]]];
+
+      /* Convert numbers without looking for the separators first, and go
+         through the following elements in bulk if possible. */
+      if (number && state == CFG_PARSE_ARRAY_START &&
+          t.state == CFG_PARSE_ARRAY_VALUE) {
+        size_t cnt;
+        size_t num = cfg_conv_numbers(value + i, len - i, dtype, size,
+            val + n * size, cap - n, &cnt);
+        if (cnt) {
+          i += num - 1;
+          n += cnt;
+          start = value + i + 1;
+          continue;
+        }
+        num = cfg_conv_number(value + i, dtype, val + n * size);
+        if (!num) {
+          err = CFG_ERR_PARSE;
+          break;
+        }
+        i += num - 1;
+        n++;
+        done = true;
+        state = CFG_PARSE_ARRAY_NUMBER_END;
+        continue;
+      }
+
+      state = t.state;
+      switch (t.action) {
+        case CFG_ACT_NONE:
+        case CFG_ACT_NEWLINE:
+          break;
+        case CFG_ACT_SEP:                       /* new array element */
+        case CFG_ACT_END:                       /* end of array */
+          value[i] = '\0';              /* add separator for value parser */
+          if (!done) {
+            if (dtype == CFG_DTYPE_STR) *((char **) val + n) = tmp;
+            if ((err = cfg_get_value(val + n * size, start,
+                value + i - start + 1, dtype, src))) break;
+            if (tmp) tmp += strlen(tmp) + 1;    /* terminated by calloc */
+            n++;
+          }
+          start = value + i + 1;
+          done = false;
+          break;
+        case CFG_ACT_DONE:
+          value[i] = '\0';            /* terminate earlier to skip comments */
+          i = len;
+          break;
+        default:
+          err = CFG_ERR_VALUE;
+      }
+    }
+    if (!err && state != CFG_PARSE_ARRAY_END) err = CFG_ERR_VALUE;
+  }
+
+  /* Hand the values over to the variable. */
+  if (!err && !cfg->arena) {
+    if (n && n < cap) {                 /* shrink the buffer to fit */
+      char *ext = cfg_realloc(cfg->alloc, val, n * size);
+      if (ext) val = ext;
+    }
+    *((void **) par->var) = val;
+    par->narr = n;
+    return 0;
+  }
+  if (!err) {           /* the pointers and characters in the same chunk */
+    const size_t slen = str ? (size_t) (tmp - str) : 0;
+    char *mem = cfg_alloc_value(cfg, par, 1, n * size + slen);
+    if (!mem) err = CFG_ERR_MEMORY;
+    else {
+      memcpy(mem, val, n * size);
+      if (str) {
+        memcpy(mem + n * size, str, slen);
+        for (i = 0; i < n; i++)
+          ((char **) mem)[i] = mem + n * size + (((char **) mem)[i] - str);
+      }
+      *((void **) par->var) = mem;
+      par->narr = n;
+    }
+  }
+  cfg_free(cfg->alloc, val);
+  if (str) cfg_free(cfg->alloc, str);
+  return err;
+}
+
+/******************************************************************************
+Function `cfg_get`:
+  Retrieve the parameter value and assign it to a variable.
+Arguments:
+  * `cfg`:      entry for all configurations;
+  * `par`:      address of the verified configuration parameter;
+  * `src`:      source of the value;
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_get(cfg_t *cfg, cfg_param_valid_t *par, int src) {
+  int err = 0;
+  /* Validate function arguments. */
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (!par->value || *par->value == '\0') return 0;     /* value not set */
+
+  /* Deal with arrays and scalars separately. */
+  if (CFG_DTYPE_IS_ARRAY(par->dtype))   /* force preprocessing the value */
+    err = cfg_get_array(cfg, par, src);
+  else {
+    /* Allocate memory only for string, unless the source is kept. */
+    if (par->dtype == CFG_DTYPE_STR && cfg->source)
+      *((char **) par->var) = NULL;
+    else if (par->dtype == CFG_DTYPE_STR) {
+      *((char **) par->var) =
+        cfg_alloc_value(cfg, par, par->vlen, sizeof(char));
+      if (!(*((char **) par->var))) err = CFG_ERR_MEMORY;
+    }
+
+    /* Assign values to the variable.  */
+    if (!err)
+      err = cfg_get_value(par->var, par->value, par->vlen, par->dtype, src);
   }
 
   switch (err) {
@@ -1027,6 +3220,7 @@ int cfg_read_opts(cfg_t *cfg, const int argc, char *const *argv,
   /* Start parsing command line options. */
   for (i = 1; i < argc; i++) {
     char *arg = argv[i];
+    CFG_STAT_ADD(cfg, nbyte, strlen(arg) + 1);
     if (!(CFG_IS_OPT(arg))) {           /* unrecognised option */
       cfg_msg(cfg, "unrecognised command line option", arg);
       continue;
@@ -1039,7 +3233,10 @@ int cfg_read_opts(cfg_t *cfg, const int argc, char *const *argv,
       if (arg[j] == '\0' || arg[j] == CFG_CMD_ASSIGN) break;
     if (arg[j] == '\0') {                       /* '=' is not found */
       j = i + 1;
-      if (j < argc && !(CFG_IS_OPT(argv[j]))) optarg = argv[++i];
+      if (j < argc && !(CFG_IS_OPT(argv[j]))) {
+        optarg = argv[++i];
+        CFG_STAT_ADD(cfg, nbyte, strlen(optarg) + 1);
+      }
     }
     else if (arg[j] == CFG_CMD_ASSIGN) {        /* '=' is found */
       arg[j] = '\0';
@@ -1055,45 +3252,21 @@ int cfg_read_opts(cfg_t *cfg, const int argc, char *const *argv,
     enum { not_found, is_param, is_func } status;
     status = not_found;
 
-    if (arg[1] != CFG_CMD_FLAG) {               /* short option */
-      for (j = 0; j < cfg->npar; j++) {
-        if (arg[1] == params[j].opt) {
-          status = is_param;
-          break;
-        }
-      }
-      if (status != is_param) {
-        for (j = 0; j < cfg->nfunc; j++) {
-          if (arg[1] == funcs[j].opt) {
-            status = is_func;
-            break;
-          }
-        }
-      }
-    }
-    else if (arg[2] != '\0') {                  /* long option */
-      for (j = 0; j < cfg->npar; j++) {
-        if (params[j].lopt &&
-            !strncmp(params[j].lopt, arg + 2, params[j].llen)) {
-          status = is_param;
-          break;
-        }
-      }
-      if (status != is_param) {
-        for (j = 0; j < cfg->nfunc; j++) {
-          if (funcs[j].lopt &&
-              !strncmp(funcs[j].lopt, arg + 2, funcs[j].llen)) {
-            status = is_func;
-            break;
-          }
-        }
-      }
-    }
+    if (arg[1] != CFG_CMD_FLAG)                 /* short option */
+      j = ((cfg_index_t *) cfg->index)->opt[(unsigned char) arg[1]];
+    else if (arg[2] != '\0')                    /* long option */
+      j = cfg_find_lopt(cfg, arg + 2);
     else {                                      /* parser termination */
       *optidx = j;                      /* for arg = "--", j = i + 1 */
       break;
     }
 
+    if (CFG_INDEX_IS_FUNC(j)) {
+      status = is_func;
+      j = CFG_FUNC_OF_INDEX(j);
+    }
+    else if (j != CFG_HASH_EMPTY) status = is_param;
+
     if (status == is_func) {            /* call the command line function */
       if (optarg) cfg_msg(cfg, "omitting command line argument", optarg);
       if (funcs[j].called)
@@ -1126,7 +3299,13 @@ int cfg_read_opts(cfg_t *cfg, const int argc, char *const *argv,
         params[j].vlen = strlen(optarg) + 1;    /* safe strlen */
       }
       /* Assign value to variable. */
+      CFG_STAT_ADD(cfg, nentry, 1);
+      CFG_STAT_START(cfg, t);
+      CFG_TRACE_START(cfg, tt);
       int err = cfg_get(cfg, params + j, CFG_SRC_OF_OPT(prior));
+      CFG_STAT_STOP(cfg, t_conv, t);
+      CFG_TRACE(cfg, CFG_EVENT_CONVERT, params[j].name, params[j].dtype,
+          CFG_DTYPE_IS_ARRAY(params[j].dtype) ? params[j].narr : 1, tt);
       if (err) return err;
       params[j].src = CFG_SRC_OF_OPT(prior);
     }
@@ -1139,251 +3318,2774 @@ int cfg_read_opts(cfg_t *cfg, const int argc, char *const *argv,
 }
 
 /******************************************************************************
-Function `cfg_read_file`:
-  Read configuration parameters from a file.
+Function `cfg_set_entry`:
+  Assign the value of a configuration entry to the parameter, according to
+  the priority of the source.
 Arguments:
   * `cfg`:      entry for the configurations;
-  * `fname`:    name of the input file;
-  * `prior`:    priority of values read from this file.
+  * `key`:      keyword of the entry;
+  * `value`:    value of the entry;
+  * `prior`:    priority of the value.
 Return:
   Zero on success; non-zero on error.
 ******************************************************************************/
-int cfg_read_file(cfg_t *cfg, const char *fname, const int prior) {
-  /* Validate function arguments. */
-  if (!cfg) return CFG_ERR_INIT;
-  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
-  if (cfg->npar <= 0) {
-    cfg_msg(cfg, "no parameter has been registered", NULL);
-    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
-  }
-  if (!fname || *fname == '\0') {
-    cfg_msg(cfg, "the input configuration file is not set", NULL);
-    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
-  }
-  if (!(cfg_strnlen(fname, CFG_MAX_FILENAME_LEN))) {
-    cfg_msg(cfg, "invalid filename of the configuration file", NULL);
-    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
-  }
-  if (prior <= CFG_SRC_NULL) {
-    cfg_msg(cfg, "invalid priority for configuration file", fname);
-    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
-  }
-
-  FILE *fp = fopen(fname, "r");
-  if (!fp) {
-    cfg_msg(cfg, "cannot open the configuration file", fname);
-    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
-  }
-
-  /* Read file by chunk. */
-  size_t clen = CFG_STR_INIT_SIZE;
-  char *chunk = calloc(clen, sizeof(char));
-  if (!chunk) {
-    fclose(fp);
-    cfg_msg(cfg, "failed to allocate memory for reading file", fname);
-    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
-  }
-
-  size_t nline, nrest, nproc, cnt;
-  char *key, *value;
-  cfg_parse_state_t state = CFG_PARSE_START;
-  nline = nrest = nproc = 0;
-  key = value = NULL;
+static int cfg_set_entry(cfg_t *cfg, const char *key, char *value,
+    const int prior) {
   cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
-
-  while ((cnt = fread(chunk + nrest, sizeof(char), clen - nrest, fp))) {
-    char *p = (state == CFG_PARSE_ARRAY_START) ? chunk + nproc : chunk;
-    char *end = chunk + nrest + cnt;
-    char *endl;
-    if (cnt < clen - nrest) *end++ = '\n';      /* terminate the last line */
-
-    /* Process lines in the chunk. */
-    while ((endl = memchr(p, '\n', end - p))) {
-      *endl = '\0';             /* replace '\n' by '\0' for line parser */
-      nline += 1;
-
-      /* Retrieve the keyword and value from the line. */
-      char msg[CFG_NUM_MAX_SIZE(size_t)];
-      int j;
-      cfg_parse_return_t status =
-        cfg_parse_line(p, endl - p, &key, &value, state);
-
-      switch (status) {
-        case CFG_PARSE_DONE:
-          /* search for the parameter given the name */
-          for (j = 0; j < cfg->npar; j++)
-            if (!strncmp(key, params[j].name, params[j].nlen)) break;
-          if (j == cfg->npar)           /* parameter not found */
-            cfg_msg(cfg, "unregistered parameter name", key);
-          else {
-            /* priority check */
-            if  (CFG_SRC_VAL(params[j].src) < prior) {
-              params[j].value = value;
-              params[j].vlen = strlen(value) + 1;
-              int err = cfg_get(cfg, params + j, prior);
-              if (err) {
-                free(chunk);
-                fclose(fp);
-                return err;
-              }
-              params[j].src = prior;
-            }
-            else if (CFG_SRC_VAL(params[j].src) == prior)
-              cfg_msg(cfg, "omitting duplicate entry of parameter", key);
-          }
-          /* reset states */
-          key = value = NULL;
-          state = CFG_PARSE_START;
-          break;
-        case CFG_PARSE_CONTINUE:        /* line continuation */
-          *endl = ' ';                  /* remove line break */
-          state = CFG_PARSE_ARRAY_START;
-          break;
-        case CFG_PARSE_ERROR:
-          sprintf(msg, "%zu", nline);
-          cfg_msg(cfg, "invalid configuration entry at line", msg);
-        case CFG_PARSE_PASS:
-          state = CFG_PARSE_START;
-          break;
-        default:
-          free(chunk);
-          fclose(fp);
-          sprintf(msg, "%d", status);
-          cfg_msg(cfg, "unknown line parser status", msg);
-          return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
-      }
-      p = endl + 1;
-    }
-
-    /* The chunk cannot hold a full line. */
-    if (p == chunk) {
-      size_t new_len = 0;
-      if (clen >= CFG_STR_MAX_DOUBLE_SIZE) {
-        if (SIZE_MAX - CFG_STR_MAX_DOUBLE_SIZE >= clen)
-          new_len = clen + CFG_STR_MAX_DOUBLE_SIZE;
-      }
-      else if (SIZE_MAX / 2 >= clen) new_len = clen << 1;
-      if (!new_len) {                   /* overflow occurred */
-        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
-        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
-      }
-      char *tmp = realloc(chunk, new_len);
-      if (!tmp) {
-        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
-        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
-      }
-      chunk = tmp;
-      clen = new_len;
-      nrest += cnt;
-      continue;
-    }
-
-    /* Copy the remaining characters to the beginning of the chunk. */
-    if (state == CFG_PARSE_ARRAY_START) {       /* copy also parsed part */
-      if (!key) {       
-        free(chunk);
-        fclose(fp);
-        cfg_msg(cfg, "unknown parser interruption", NULL);
-        return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
-      }
-      /* `key` is the starting point of this effective line */
-      nrest = end - key;
-      nproc = p - key;
-      memmove(chunk, key, nrest);
-      /* shift `key` and `value` */
-      if (value) value -= key - chunk;
-      key = chunk;
-    }
-    else {                      /* copy only from the current position */
-      nrest = end - p;
-      memmove(chunk, p, nrest);
-    }
-
-    /* The chunk is full. */
-    if (nrest == clen) {
-      size_t new_len = 0;
-      if (clen >= CFG_STR_MAX_DOUBLE_SIZE) {
-        if (SIZE_MAX - CFG_STR_MAX_DOUBLE_SIZE >= clen)
-          new_len = clen + CFG_STR_MAX_DOUBLE_SIZE;
-      }
-      else if (SIZE_MAX / 2 >= clen) new_len = clen << 1;
-      if (!new_len) {
-        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
-        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
-      }
-      size_t key_shift = key ? key - chunk : 0;
-      size_t value_shift = value ? value - chunk : 0;
-      char *tmp = realloc(chunk, new_len);
-      if (!tmp) {
-        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
-        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
-      }
-      chunk = tmp;
-      clen = new_len;
-      if (key) key = chunk + key_shift;
-      if (value) value = chunk + value_shift;
+  CFG_STAT_ADD(cfg, nentry, 1);
+  /* search for the parameter given the name */
+  const int j = cfg_find_name(cfg, key);
+  if (j == CFG_HASH_EMPTY)              /* parameter not found */
+    cfg_msg(cfg, "unregistered parameter name", key);
+  else {
+    /* priority check */
+    if  (CFG_SRC_VAL(params[j].src) < prior) {
+      params[j].value = value;
+      params[j].vlen = strlen(value) + 1;
+      CFG_STAT_START(cfg, t);
+      CFG_TRACE_START(cfg, tt);
+      const int err = cfg_get(cfg, params + j, prior);
+      CFG_STAT_STOP(cfg, t_conv, t);
+      CFG_TRACE(cfg, CFG_EVENT_CONVERT, key, params[j].dtype,
+          CFG_DTYPE_IS_ARRAY(params[j].dtype) ? params[j].narr : 1, tt);
+      if (err) return CFG_ERRNO(cfg);
+      params[j].src = prior;
     }
+    else if (CFG_SRC_VAL(params[j].src) == prior)
+      cfg_msg(cfg, "omitting duplicate entry of parameter", key);
   }
-
-  if (!feof(fp)) {
-    cfg_msg(cfg, "unexpected end of file", fname);
-    free(chunk);
-    fclose(fp);
-    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
-  }
-
-  free(chunk);
-  fclose(fp);
   return 0;
 }
 
-
-/*============================================================================*\
-                 Functions for checking the status of variables
-\*============================================================================*/
-
 /******************************************************************************
-Function `cfg_is_set`:
-  Check if a variable is set via the command line or files.
+Function `cfg_parse_lines`:
+  Parse all the complete lines of a string, and assign values to variables.
 Arguments:
-  * `cfg`:      entry of all configurations;
-  * `var`:      address of the variable.
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader;
+  * `p`:        starting point of the string;
+  * `end`:      ending point of the string.
 Return:
-  True if the variable is set; false otherwise.
+  Starting point of the first incomplete line on success; NULL on error.
 ******************************************************************************/
-bool cfg_is_set(const cfg_t *cfg, const void *var) {
-  if (!cfg || !var || !cfg->npar) return false;
-  for (int i = 0; i < cfg->npar; i++) {
-    cfg_param_valid_t *par = (cfg_param_valid_t *) cfg->params + i;
-    if (par->var == var) {
-      if (par->src != CFG_SRC_NULL) return true;
-      break;
+static char *cfg_parse_lines(cfg_t *cfg, cfg_reader_t *rd, char *p,
+    char *end) {
+  char *endl;
+  CFG_STAT_TOKEN_START(cfg, t);
+
+  while ((endl = memchr(p, '\n', end - p))) {
+    *endl = '\0';               /* replace '\n' by '\0' for line parser */
+    rd->nline += 1;
+    CFG_STAT_ADD(cfg, nline, 1);
+
+    /* Retrieve the keyword and value from the line. */
+    char msg[CFG_NUM_MAX_SIZE(size_t)];
+    cfg_parse_return_t status =
+      cfg_parse_line(p, endl - p, &rd->key, &rd->value, rd->state);
+
+    switch (status) {
+      case CFG_PARSE_DONE:
+        if (cfg_set_entry(cfg, rd->key, rd->value, rd->prior)) {
+          CFG_STAT_TOKEN_STOP(cfg, t);
+          return NULL;
+        }
+        /* reset states */
+        rd->key = rd->value = NULL;
+        rd->state = CFG_PARSE_START;
+        break;
+      case CFG_PARSE_CONTINUE:          /* line continuation */
+        *endl = ' ';                    /* remove line break */
+        rd->state = CFG_PARSE_ARRAY_START;
+        CFG_STAT_ADD(cfg, ncont, 1);
+        break;
+      case CFG_PARSE_ERROR:
+        sprintf(msg, "%zu", rd->nline);
+        cfg_msg(cfg, "invalid configuration entry at line", msg);
+      case CFG_PARSE_PASS:
+        rd->state = CFG_PARSE_START;
+        break;
+      default:
+        sprintf(msg, "%d", status);
+        cfg_msg(cfg, "unknown line parser status", msg);
+        CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
+        CFG_STAT_TOKEN_STOP(cfg, t);
+        return NULL;
     }
+    p = endl + 1;
   }
-  return false;
+  CFG_STAT_TOKEN_STOP(cfg, t);
+  return p;
 }
 
 /******************************************************************************
-Function `cfg_get_size`:
-  Return the number of elements for the parsed array.
+Function `cfg_reader_init`:
+  Initialise the state of the configuration reader.
 Arguments:
-  * `cfg`:      entry of all configurations;
-  * `var`:      address of the variable.
+  * `rd`:       state of the configuration reader;
+  * `prior`:    priority of values read by this reader.
+******************************************************************************/
+static void cfg_reader_init(cfg_reader_t *rd, const int prior) {
+  rd->prior = prior;
+  rd->nline = 0;
+  rd->state = CFG_PARSE_START;
+  rd->key = rd->value = rd->buf = NULL;
+  rd->pos = rd->len = rd->cap = 0;
+}
+
+/******************************************************************************
+Function `cfg_reader_append`:
+  Append characters to the buffer of the configuration reader.
+Arguments:
+  * `rd`:       state of the configuration reader;
+  * `src`:      the characters to be appended;
+  * `len`:      number of characters;
+  * `alloc`:    the allocation functions.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_reader_append(cfg_reader_t *rd, const char *src,
+    const size_t len, const cfg_allocator_t *alloc) {
+  if (len > SIZE_MAX - rd->len) return CFG_ERR_MEMORY;
+  if (rd->len + len > rd->cap) {
+    size_t cap = cfg_grow_size(rd->cap ? rd->cap : CFG_STR_INIT_SIZE,
+        rd->len + len, sizeof(char));
+    if (!cap) return CFG_ERR_MEMORY;
+    char *tmp = cfg_realloc(alloc, rd->buf, cap);
+    if (!tmp) return CFG_ERR_MEMORY;
+    /* shift `key` and `value` */
+    if (rd->key) rd->key = tmp + (rd->key - rd->buf);
+    if (rd->value) rd->value = tmp + (rd->value - rd->buf);
+    rd->buf = tmp;
+    rd->cap = cap;
+  }
+  memcpy(rd->buf + rd->len, src, len);
+  rd->len += len;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_reader_parse`:
+  Parse the buffered line of the configuration reader, and keep only the
+  characters that are needed for the next line.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_reader_parse(cfg_t *cfg, cfg_reader_t *rd) {
+  if (!cfg_parse_lines(cfg, rd, rd->buf + rd->pos, rd->buf + rd->len))
+    return CFG_ERRNO(cfg);
+
+  if (rd->state == CFG_PARSE_ARRAY_START) {     /* keep the parsed part */
+    if (!rd->key) {
+      cfg_msg(cfg, "unknown parser interruption", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
+    }
+    /* `key` is the starting point of this effective line, which is moved
+       only once, since it stays at the beginning for continuation lines */
+    if (rd->key != rd->buf) {
+      rd->len -= rd->key - rd->buf;
+      memmove(rd->buf, rd->key, rd->len);
+      CFG_STAT_ADD(cfg, nmove, rd->len);
+      if (rd->value) rd->value -= rd->key - rd->buf;
+      rd->key = rd->buf;
+    }
+    rd->pos = rd->len;
+  }
+  else rd->pos = rd->len = 0;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_source_add`:
+  Retain a buffer of configuration text until `cfg_destroy`.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `addr`:     address of the buffer;
+  * `size`:     size of the memory mapping; 0 for allocated buffers.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_source_add(cfg_t *cfg, void *addr, const size_t size) {
+  if (!addr) return 0;
+  cfg_source_t *source = (cfg_source_t *) cfg->source;
+  cfg_source_buf_t *buf = cfg_malloc(cfg->alloc, sizeof(cfg_source_buf_t));
+  if (!buf) {           /* the buffer may be referenced, so it is leaked */
+    cfg_msg(cfg, "failed to allocate memory for the configuration text",
+        NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  buf->addr = addr;
+  buf->size = size;
+  buf->next = source->buf;
+  source->buf = buf;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_shared_add`:
+  Retain a mapping of shared memory, or memory referring to it, until
+  `cfg_destroy`.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `addr`:     address of the memory;
+  * `size`:     size of the memory mapping; 0 for allocated memory.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_shared_add(cfg_t *cfg, void *addr, const size_t size) {
+  cfg_source_t *shared = (cfg_source_t *) cfg->shared;
+  cfg_source_buf_t *buf = cfg_malloc(cfg->alloc, sizeof(cfg_source_buf_t));
+  if (!shared) {
+    if (!(shared = cfg_calloc(cfg->alloc, 1, sizeof(cfg_source_t)))) {
+      if (buf) cfg_free(cfg->alloc, buf);
+      buf = NULL;
+    }
+    else cfg->shared = shared;
+  }
+  if (!buf) {
+    cfg_msg(cfg, "failed to allocate memory for the shared configurations",
+        NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  buf->addr = addr;
+  buf->size = size;
+  buf->next = shared->buf;
+  shared->buf = buf;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_source_free`:
+  Release the retained buffers, as well as the structure for them.
+Arguments:
+  * `source`:   the retained buffers;
+  * `alloc`:    the allocation functions.
+******************************************************************************/
+static void cfg_source_free(cfg_source_t *source,
+    const cfg_allocator_t *alloc) {
+  while (source->buf) {
+    cfg_source_buf_t *buf = source->buf;
+    source->buf = buf->next;
+#ifdef CFG_ENABLE_POSIX
+    if (buf->size) munmap(buf->addr, buf->size);
+    else cfg_free(alloc, buf->addr);
+#else
+    cfg_free(alloc, buf->addr);
+#endif
+    cfg_free(alloc, buf);
+  }
+  cfg_free(alloc, source);
+}
+
+/******************************************************************************
+Function `cfg_reader_reserve`:
+  Make sure that the buffer of the reader can hold the given number of
+  characters, as well as a final line break, when the configuration text is
+  kept.  The buffer is never reallocated, since it may be referenced by
+  string values; instead, a larger buffer is started with the incomplete
+  line, and the old one is retained.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader;
+  * `num`:      number of characters to be appended.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_reader_reserve(cfg_t *cfg, cfg_reader_t *rd, const size_t num) {
+  if (rd->buf && rd->cap - rd->len > num) return 0;
+
+  /* Carry also the parsed part of a continued line. */
+  char *from = rd->buf ? rd->buf + rd->pos : NULL;
+  if (rd->buf && rd->state == CFG_PARSE_ARRAY_START) {
+    if (!rd->key) {
+      cfg_msg(cfg, "unknown parser interruption", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
+    }
+    from = rd->key;
+  }
+  const size_t carry = rd->buf ? rd->len - (from - rd->buf) : 0;
+  const size_t parsed = rd->buf ? rd->pos - (from - rd->buf) : 0;
+
+  /* Grow the buffers geometrically. */
+  size_t cap = 0;
+  if (num < SIZE_MAX - carry) {
+    size_t len = carry + num + 1;
+    if (rd->cap <= SIZE_MAX / 2 && len < rd->cap * 2) len = rd->cap * 2;
+    cap = cfg_grow_size(CFG_STR_INIT_SIZE, len, sizeof(char));
+  }
+  char *buf = cap ? cfg_malloc(cfg->alloc, cap) : NULL;
+  if (!buf) {
+    cfg_msg(cfg, "failed to allocate memory for the configuration text",
+        NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  if (carry) memcpy(buf, from, carry);
+  CFG_STAT_ADD(cfg, nrealloc, rd->buf ? 1 : 0);
+  CFG_STAT_ADD(cfg, nmove, carry);
+  if (rd->buf && rd->state == CFG_PARSE_ARRAY_START) {
+    if (rd->value) rd->value = buf + (rd->value - from);
+    rd->key = buf;
+  }
+
+  /* Values can only be found before the carried characters. */
+  if (rd->buf) {
+    if (from == rd->buf) cfg_free(cfg->alloc, rd->buf);
+    else if (cfg_source_add(cfg, rd->buf, 0)) {
+      cfg_free(cfg->alloc, buf);
+      return CFG_ERRNO(cfg);
+    }
+  }
+  rd->buf = buf;
+  rd->cap = cap;
+  rd->len = carry;
+  rd->pos = parsed;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_reader_scan`:
+  Parse the complete lines of the characters appended to the buffer of the
+  reader, when the configuration text is kept.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader;
+  * `num`:      number of appended characters.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_reader_scan(cfg_t *cfg, cfg_reader_t *rd, const size_t num) {
+  rd->len += num;
+  char *p = cfg_parse_lines(cfg, rd, rd->buf + rd->pos, rd->buf + rd->len);
+  if (!p) return CFG_ERRNO(cfg);
+  rd->pos = p - rd->buf;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_reader_release`:
+  Release the buffer of the reader, or retain it if the configuration text
+  is kept.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader.
+******************************************************************************/
+static void cfg_reader_release(cfg_t *cfg, cfg_reader_t *rd) {
+  if (!rd->buf) return;
+  if (!cfg->source) cfg_free(cfg->alloc, rd->buf);
+  else cfg_source_add(cfg, rd->buf, 0);
+  rd->buf = NULL;
+}
+
+/******************************************************************************
+Function `cfg_reader_push`:
+  Parse configuration text with the reader, by copying only one line at a
+  time, and keep the incomplete line for the next push.  If the text is kept
+  for string values, it is copied entirely to the buffer of the reader.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader;
+  * `src`:      the configuration text;
+  * `len`:      length of the text.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_reader_push(cfg_t *cfg, cfg_reader_t *rd, const char *src,
+    size_t len) {
+  if (cfg->source) {            /* copy all characters at once */
+    int err = cfg_reader_reserve(cfg, rd, len);
+    if (err) return err;
+    memcpy(rd->buf + rd->len, src, len);
+    return cfg_reader_scan(cfg, rd, len);
+  }
+
+  const char *endl;
+  while ((endl = memchr(src, '\n', len))) {
+    const size_t n = endl - src + 1;
+    CFG_STAT_ADD(cfg, nrealloc, rd->buf && rd->len + n > rd->cap);
+    if (cfg_reader_append(rd, src, n, cfg->alloc)) {
+      cfg_msg(cfg, "failed to allocate memory for the configuration line",
+          NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    }
+    int err = cfg_reader_parse(cfg, rd);
+    if (err) return err;
+    src += n;
+    len -= n;
+  }
+
+  /* Keep the incomplete line. */
+  CFG_STAT_ADD(cfg, nrealloc, rd->buf && rd->len + len > rd->cap);
+  if (len && cfg_reader_append(rd, src, len, cfg->alloc)) {
+    cfg_msg(cfg, "failed to allocate memory for the configuration line",
+        NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_reader_finish`:
+  Parse the last line kept by the reader, and release the buffer.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_reader_finish(cfg_t *cfg, cfg_reader_t *rd) {
+  int err = 0;
+  if (rd->len > rd->pos) {
+    if (cfg->source) {          /* the space is reserved for line break */
+      rd->buf[rd->len] = '\n';
+      err = cfg_reader_scan(cfg, rd, 1);
+    }
+    else err = cfg_reader_push(cfg, rd, "\n", 1);
+  }
+  cfg_reader_release(cfg, rd);
+  cfg_reader_init(rd, rd->prior);
+  return err;
+}
+
+#ifdef CFG_ENABLE_POSIX
+/******************************************************************************
+Function `cfg_read_map`:
+  Read configuration parameters from a privately memory-mapped file.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `rd`:       state of the configuration reader;
+  * `map`:      starting address of the mapped file;
+  * `size`:     size of the file;
+  * `fname`:    name of the input file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_read_map(cfg_t *cfg, cfg_reader_t *rd, char *map,
+    const size_t size, const char *fname) {
+  /* Lines are terminated in place, since the mapping is copy-on-write. */
+  char *end = map + size;
+  char *p = cfg_parse_lines(cfg, rd, map, end);
+  if (!p) return CFG_ERRNO(cfg);
+  if (p == end) return 0;
+
+  /* Copy the last line without line break, for terminating it. */
+  char *start = p;
+  if (rd->state == CFG_PARSE_ARRAY_START) {     /* copy also parsed part */
+    if (!rd->key) {
+      cfg_msg(cfg, "unknown parser interruption", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
+    }
+    start = rd->key;
+  }
+  const size_t len = end - start;
+  char *tail = cfg_malloc(cfg->alloc, len + 1);
+  if (!tail) {
+    cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  memcpy(tail, start, len);
+  tail[len] = '\n';
+  if (rd->state == CFG_PARSE_ARRAY_START) {
+    if (rd->value) rd->value = tail + (rd->value - start);
+    rd->key = tail;
+  }
+
+  p = cfg_parse_lines(cfg, rd, tail + (p - start), tail + len + 1);
+  if (!cfg->source) cfg_free(cfg->alloc, tail);
+  else if (cfg_source_add(cfg, tail, 0)) return CFG_ERRNO(cfg);
+  return p ? 0 : CFG_ERRNO(cfg);
+}
+#endif
+
+/******************************************************************************
+Function `cfg_read_file`:
+  Read configuration parameters from a file.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the input file;
+  * `prior`:    priority of values read from this file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_read_file(cfg_t *cfg, const char *fname, const int prior) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->npar <= 0) {
+    cfg_msg(cfg, "no parameter has been registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
+  }
+  if (!fname || *fname == '\0') {
+    cfg_msg(cfg, "the input configuration file is not set", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  if (!(cfg_strnlen(fname, CFG_MAX_FILENAME_LEN))) {
+    cfg_msg(cfg, "invalid filename of the configuration file", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  if (prior <= CFG_SRC_NULL) {
+    cfg_msg(cfg, "invalid priority for configuration file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  CFG_STAT_START(cfg, topen);
+  CFG_TRACE_START(cfg, ttopen);
+  FILE *fp = fopen(fname, "r");
+  CFG_STAT_STOP(cfg, t_io, topen);
+  if (!fp) {
+    cfg_msg(cfg, "cannot open the configuration file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
+  }
+  CFG_TRACE(cfg, CFG_EVENT_FILE_OPEN, fname, CFG_DTYPE_NULL, 0, ttopen);
+
+  cfg_reader_t rd;
+  cfg_reader_init(&rd, prior);
+
+#ifdef CFG_ENABLE_POSIX
+  /* Parse large regular files directly from the mapped pages.  Pages that
+     are not written by the parser are still backed by the file, so they are
+     not retained for string values. */
+  struct stat st;
+  if (!cfg->source && !fstat(fileno(fp), &st) && S_ISREG(st.st_mode) &&
+      st.st_size >= CFG_MMAP_MIN_SIZE && (uintmax_t) st.st_size <= SIZE_MAX) {
+    const size_t size = st.st_size;
+    CFG_STAT_START(cfg, tmap);
+    CFG_TRACE_START(cfg, ttmap);
+    char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+        fileno(fp), 0);
+    CFG_STAT_STOP(cfg, t_io, tmap);
+    if (map != MAP_FAILED) {
+      posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+      CFG_STAT_ADD(cfg, nbyte, size);
+      CFG_TRACE(cfg, CFG_EVENT_CHUNK_READ, fname, CFG_DTYPE_NULL, size, ttmap);
+      const int err = cfg_read_map(cfg, &rd, map, size, fname);
+      munmap(map, size);
+      fclose(fp);
+      return err;
+    }
+  }
+#endif
+
+  /* Read the file into buffers that are retained for string values. */
+  if (cfg->source) {
+    size_t cnt = 0;
+    int err;
+    do {
+      if ((err = cfg_reader_reserve(cfg, &rd, CFG_STR_INIT_SIZE))) break;
+      CFG_STAT_START(cfg, tread);
+      CFG_TRACE_START(cfg, ttread);
+      cnt = fread(rd.buf + rd.len, sizeof(char), rd.cap - rd.len - 1, fp);
+      CFG_STAT_STOP(cfg, t_io, tread);
+      CFG_STAT_ADD(cfg, nbyte, cnt);
+      CFG_TRACE(cfg, CFG_EVENT_CHUNK_READ, fname, CFG_DTYPE_NULL, cnt, ttread);
+    } while (cnt && !(err = cfg_reader_scan(cfg, &rd, cnt)));
+
+    if (!err && !feof(fp)) {
+      cfg_msg(cfg, "unexpected end of file", fname);
+      err = CFG_ERRNO(cfg) = CFG_ERR_FILE;
+    }
+    if (!err) err = cfg_reader_finish(cfg, &rd);
+    else cfg_reader_release(cfg, &rd);
+    fclose(fp);
+    return err;
+  }
+
+  /* Read file by chunk. */
+  size_t clen = CFG_STR_INIT_SIZE;
+  char *chunk = cfg_calloc(cfg->alloc, clen, sizeof(char));
+  if (!chunk) {
+    fclose(fp);
+    cfg_msg(cfg, "failed to allocate memory for reading file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+
+  size_t nrest, nproc, cnt;
+  nrest = nproc = 0;
+
+  for (;;) {
+    CFG_STAT_START(cfg, tread);
+    CFG_TRACE_START(cfg, ttread);
+    cnt = fread(chunk + nrest, sizeof(char), clen - nrest, fp);
+    CFG_STAT_STOP(cfg, t_io, tread);
+    if (!cnt) break;
+    CFG_STAT_ADD(cfg, nbyte, cnt);
+    CFG_TRACE(cfg, CFG_EVENT_CHUNK_READ, fname, CFG_DTYPE_NULL, cnt, ttread);
+    char *p = (rd.state == CFG_PARSE_ARRAY_START) ? chunk + nproc : chunk;
+    char *end = chunk + nrest + cnt;
+    if (cnt < clen - nrest) *end++ = '\n';      /* terminate the last line */
+
+    /* Process lines in the chunk. */
+    if (!(p = cfg_parse_lines(cfg, &rd, p, end))) {
+      cfg_free(cfg->alloc, chunk);
+      fclose(fp);
+      return CFG_ERRNO(cfg);
+    }
+
+    /* The chunk cannot hold a full line. */
+    if (p == chunk) {
+      size_t new_len = 0;
+      if (clen >= CFG_STR_MAX_DOUBLE_SIZE) {
+        if (SIZE_MAX - CFG_STR_MAX_DOUBLE_SIZE >= clen)
+          new_len = clen + CFG_STR_MAX_DOUBLE_SIZE;
+      }
+      else if (SIZE_MAX / 2 >= clen) new_len = clen << 1;
+      if (!new_len) {                   /* overflow occurred */
+        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
+        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+      }
+      char *tmp = cfg_realloc(cfg->alloc, chunk, new_len);
+      if (!tmp) {
+        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
+        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+      }
+      chunk = tmp;
+      clen = new_len;
+      nrest += cnt;
+      CFG_STAT_ADD(cfg, nrealloc, 1);
+      continue;
+    }
+
+    /* Copy the remaining characters to the beginning of the chunk. */
+    if (rd.state == CFG_PARSE_ARRAY_START) {    /* copy also parsed part */
+      if (!rd.key) {
+        cfg_free(cfg->alloc, chunk);
+        fclose(fp);
+        cfg_msg(cfg, "unknown parser interruption", NULL);
+        return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
+      }
+      /* `key` is the starting point of this effective line */
+      nrest = end - rd.key;
+      nproc = p - rd.key;
+      if (rd.key != chunk) {
+        memmove(chunk, rd.key, nrest);
+        CFG_STAT_ADD(cfg, nmove, nrest);
+        /* shift `key` and `value` */
+        if (rd.value) rd.value -= rd.key - chunk;
+        rd.key = chunk;
+      }
+    }
+    else {                      /* copy only from the current position */
+      nrest = end - p;
+      if (p != chunk) {
+        memmove(chunk, p, nrest);
+        CFG_STAT_ADD(cfg, nmove, nrest);
+      }
+    }
+
+    /* The chunk is full. */
+    if (nrest == clen) {
+      size_t new_len = 0;
+      if (clen >= CFG_STR_MAX_DOUBLE_SIZE) {
+        if (SIZE_MAX - CFG_STR_MAX_DOUBLE_SIZE >= clen)
+          new_len = clen + CFG_STR_MAX_DOUBLE_SIZE;
+      }
+      else if (SIZE_MAX / 2 >= clen) new_len = clen << 1;
+      if (!new_len) {
+        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
+        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+      }
+      size_t key_shift = rd.key ? rd.key - chunk : 0;
+      size_t value_shift = rd.value ? rd.value - chunk : 0;
+      char *tmp = cfg_realloc(cfg->alloc, chunk, new_len);
+      if (!tmp) {
+        cfg_msg(cfg, "failed to allocate memory for reading the file", fname);
+        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+      }
+      chunk = tmp;
+      clen = new_len;
+      CFG_STAT_ADD(cfg, nrealloc, 1);
+      if (rd.key) rd.key = chunk + key_shift;
+      if (rd.value) rd.value = chunk + value_shift;
+    }
+  }
+
+  if (!feof(fp)) {
+    cfg_msg(cfg, "unexpected end of file", fname);
+    cfg_free(cfg->alloc, chunk);
+    fclose(fp);
+    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
+  }
+
+  cfg_free(cfg->alloc, chunk);
+  fclose(fp);
+  return 0;
+}
+
+
+/******************************************************************************
+Function `cfg_file_load`:
+  Read a configuration file entirely, and split it into entries without
+  assigning values to parameters, which can be done by any thread.
+Arguments:
+  * `file`:     the configuration file.
+******************************************************************************/
+static void cfg_file_load(cfg_file_t *file) {
+  if (file->timed) file->time[0] = cfg_time();
+  FILE *fp = fopen(file->fname, "r");
+  if (file->timed) file->time[1] = cfg_time();
+  if (!fp) {
+    file->msg = "cannot open the configuration file";
+    file->err = CFG_ERR_FILE;
+    return;
+  }
+
+  /* Read the whole file, with a line break reserved at the end. */
+  size_t cap = CFG_STR_INIT_SIZE, len = 0, cnt;
+  char *buf = cfg_malloc(file->alloc, cap);
+  while (buf && (cnt = fread(buf + len, sizeof(char), cap - len - 1, fp))) {
+    if ((len += cnt) + 1 < cap) continue;
+    const size_t size = cfg_grow_size(cap, cap + 1, sizeof(char));
+    char *tmp = size ? cfg_realloc(file->alloc, buf, size) : NULL;
+    if (!tmp) cfg_free(file->alloc, buf);
+    buf = tmp;
+    cap = size;
+  }
+  if (!buf || !feof(fp)) {
+    if (buf) cfg_free(file->alloc, buf);
+    fclose(fp);
+    file->msg = buf ? "unexpected end of file" :
+        "failed to allocate memory for reading the file";
+    file->err = buf ? CFG_ERR_FILE : CFG_ERR_MEMORY;
+    return;
+  }
+  fclose(fp);
+  buf[len++] = '\n';                    /* terminate the last line */
+  file->buf = buf;
+  file->len = len;
+  if (file->timed) file->time[2] = cfg_time();
+
+  /* Record the entries and the invalid lines in order. */
+  cfg_parse_state_t state = CFG_PARSE_START;
+  char *key = NULL, *value = NULL, *p = buf, *endl;
+  size_t nline = 0;
+  while ((endl = memchr(p, '\n', buf + len - p))) {
+    *endl = '\0';               /* replace '\n' by '\0' for line parser */
+    nline += 1;
+    const cfg_parse_return_t status =
+      cfg_parse_line(p, endl - p, &key, &value, state);
+    if (status == CFG_PARSE_CONTINUE) {
+      *endl = ' ';                      /* remove line break */
+      state = CFG_PARSE_ARRAY_START;
+#ifdef CFG_ENABLE_STATS
+      file->ncont += 1;
+#endif
+    }
+    else {
+      if (status != CFG_PARSE_PASS) {
+        if (file->num == file->cap) {
+          const size_t size = cfg_grow_size(file->cap, file->num + 1,
+              sizeof(cfg_entry_t));
+          cfg_entry_t *tmp = size ? cfg_realloc(file->alloc, file->entry,
+              size * sizeof(cfg_entry_t)) : NULL;
+          if (!tmp) {
+            file->msg = "failed to allocate memory for reading the file";
+            file->err = CFG_ERR_MEMORY;
+            return;
+          }
+          file->entry = tmp;
+          file->cap = size;
+        }
+        file->entry[file->num].status = status;
+        file->entry[file->num].nline = nline;
+        file->entry[file->num].key = key;
+        file->entry[file->num++].value = value;
+      }
+      if (status == CFG_PARSE_DONE) key = value = NULL;
+      state = CFG_PARSE_START;
+    }
+    p = endl + 1;
+  }
+  if (file->timed) file->time[3] = cfg_time();
+#ifdef CFG_ENABLE_STATS
+  file->nline = nline;
+#endif
+}
+
+#ifdef CFG_ENABLE_THREADS
+/******************************************************************************
+Function `cfg_file_task`:
+  Load the configuration files assigned to a thread.
+Arguments:
+  * `arg`:      the files for the thread.
+Return:
+  NULL.
+******************************************************************************/
+static void *cfg_file_task(void *arg) {
+  cfg_file_task_t *task = (cfg_file_task_t *) arg;
+  for (int i = 0; i < task->num; i += task->step)
+    cfg_file_load(task->file + i);
+  return NULL;
+}
+#endif
+
+/******************************************************************************
+Function `cfg_file_apply`:
+  Assign values of the entries of a loaded configuration file to parameters,
+  and report the invalid lines.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `file`:     the loaded configuration file;
+  * `prior`:    priority of values read from this file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_file_apply(cfg_t *cfg, const cfg_file_t *file,
+    const int prior) {
+  if (file->err) {
+    cfg_msg(cfg, file->msg, file->fname);
+    return CFG_ERRNO(cfg) = file->err;
+  }
+  for (size_t i = 0; i < file->num; i++) {
+    const cfg_entry_t *entry = file->entry + i;
+    char msg[CFG_NUM_MAX_SIZE(size_t)];
+    switch (entry->status) {
+      case CFG_PARSE_DONE:
+        if (cfg_set_entry(cfg, entry->key, entry->value, prior))
+          return CFG_ERRNO(cfg);
+        break;
+      case CFG_PARSE_ERROR:
+        sprintf(msg, "%zu", entry->nline);
+        cfg_msg(cfg, "invalid configuration entry at line", msg);
+        break;
+      default:
+        sprintf(msg, "%d", entry->status);
+        cfg_msg(cfg, "unknown line parser status", msg);
+        return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
+    }
+  }
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_read_files`:
+  Read configuration parameters from multiple files.  The files are read and
+  split into entries concurrently, and the values are assigned in the order
+  of the files, with the same result as `cfg_read_file` called on each file.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fnames`:   names of the input files;
+  * `priors`:   priorities of values read from each file;
+  * `nfile`:    number of files;
+  * `nthread`:  maximum number of threads for reading files.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_read_files(cfg_t *cfg, const char *const *fnames, const int *priors,
+    const int nfile, const int nthread) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->npar <= 0) {
+    cfg_msg(cfg, "no parameter has been registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
+  }
+  if (!fnames || !priors || nfile <= 0) {
+    cfg_msg(cfg, "the input configuration files are not set", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  if (nthread <= 0) {
+    cfg_msg(cfg, "invalid number of threads", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  for (int i = 0; i < nfile; i++) {
+    if (!fnames[i] || *fnames[i] == '\0') {
+      cfg_msg(cfg, "the input configuration file is not set", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+    }
+    if (!(cfg_strnlen(fnames[i], CFG_MAX_FILENAME_LEN))) {
+      cfg_msg(cfg, "invalid filename of the configuration file", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+    }
+    if (priors[i] <= CFG_SRC_NULL) {
+      cfg_msg(cfg, "invalid priority for configuration file", fnames[i]);
+      return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+    }
+  }
+
+  cfg_file_t *file = cfg_calloc(cfg->alloc, nfile, sizeof(cfg_file_t));
+  if (!file) {
+    cfg_msg(cfg, "failed to allocate memory for reading files", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  for (int i = 0; i < nfile; i++) {
+    file[i].fname = fnames[i];
+    file[i].buf = NULL;
+    file[i].entry = NULL;
+    file[i].msg = NULL;
+    file[i].alloc = cfg->alloc;
+    file[i].timed = (cfg->stats || cfg->trace);
+  }
+
+  /* Load the files, with the i-th thread taking every `nthread` files. */
+#ifdef CFG_ENABLE_THREADS
+  const int ntask = (nthread < nfile) ? nthread : nfile;
+  cfg_file_task_t *task =
+    cfg_calloc(cfg->alloc, ntask, sizeof(cfg_file_task_t));
+  if (task) {
+    for (int i = 0; i < ntask; i++) {
+      task[i].file = file + i;
+      task[i].num = nfile - i;
+      task[i].step = ntask;
+    }
+    cfg_run_threads(cfg_file_task, task, sizeof(cfg_file_task_t), ntask,
+        cfg->alloc);
+    cfg_free(cfg->alloc, task);
+  }
+  else for (int i = 0; i < nfile; i++) cfg_file_load(file + i);
+#else
+  for (int i = 0; i < nfile; i++) cfg_file_load(file + i);
+#endif
+
+  /* Assign the values in the order of the files. */
+  int err = 0;
+  for (int i = 0; i < nfile; i++) {
+    /* Files are loaded concurrently, so the times of all files are summed. */
+    CFG_STAT_ADD(cfg, nbyte, file[i].len ? file[i].len - 1 : 0);
+    CFG_STAT_ADD(cfg, nline, file[i].nline);
+    CFG_STAT_ADD(cfg, ncont, file[i].ncont);
+    if (file[i].timed && !file[i].err) {
+      CFG_STAT_ADD(cfg, t_io, file[i].time[2] - file[i].time[0]);
+      CFG_STAT_ADD(cfg, t_token, file[i].time[3] - file[i].time[2]);
+      if (cfg->trace) {
+        cfg_trace(cfg, CFG_EVENT_FILE_OPEN, file[i].fname, CFG_DTYPE_NULL, 0,
+            file[i].time[0], file[i].time[1]);
+        cfg_trace(cfg, CFG_EVENT_CHUNK_READ, file[i].fname, CFG_DTYPE_NULL,
+            file[i].len - 1, file[i].time[1], file[i].time[2]);
+      }
+    }
+    if (!err) err = cfg_file_apply(cfg, file + i, priors[i]);
+    if (file[i].buf) {
+      if (!cfg->source || file[i].err) cfg_free(cfg->alloc, file[i].buf);
+      else if (cfg_source_add(cfg, file[i].buf, 0) && !err)
+        err = CFG_ERRNO(cfg);
+    }
+    if (file[i].entry) cfg_free(cfg->alloc, file[i].entry);
+  }
+  cfg_free(cfg->alloc, file);
+  return err;
+}
+
+/******************************************************************************
+Function `cfg_read_buffer`:
+  Read configuration parameters from a string in memory.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `buf`:      the configuration text, which is not modified;
+  * `len`:      length of the text;
+  * `prior`:    priority of values read from this string.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_read_buffer(cfg_t *cfg, const char *buf, const size_t len,
+    const int prior) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->npar <= 0) {
+    cfg_msg(cfg, "no parameter has been registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
+  }
+  if (!buf && len) {
+    cfg_msg(cfg, "the input configuration string is not set", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  if (prior <= CFG_SRC_NULL) {
+    cfg_msg(cfg, "invalid priority for configuration string", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  cfg_reader_t rd;
+  cfg_reader_init(&rd, prior);
+  CFG_STAT_ADD(cfg, nbyte, len);
+  int err = len ? cfg_reader_push(cfg, &rd, buf, len) : 0;
+  if (err) {
+    cfg_reader_release(cfg, &rd);
+    return err;
+  }
+  return cfg_reader_finish(cfg, &rd);
+}
+
+
+/******************************************************************************
+Function `cfg_feed`:
+  Parse a fragment of streamed configuration text; incomplete lines are kept
+  until the following fragments or `cfg_feed_end` are supplied.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `data`:     the fragment of configuration text, which is not modified;
+  * `len`:      length of the fragment;
+  * `prior`:    priority of values read from this stream.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_feed(cfg_t *cfg, const char *data, const size_t len, const int prior) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->npar <= 0) {
+    cfg_msg(cfg, "no parameter has been registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
+  }
+  if (!data && len) {
+    cfg_msg(cfg, "the input configuration string is not set", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  if (prior <= CFG_SRC_NULL) {
+    cfg_msg(cfg, "invalid priority for configuration stream", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  /* Start a new stream if necessary. */
+  cfg_reader_t *rd = (cfg_reader_t *) cfg->reader;
+  if (!rd) {
+    if (!(rd = cfg_malloc(cfg->alloc, sizeof(cfg_reader_t)))) {
+      cfg_msg(cfg, "failed to allocate memory for configuration stream", NULL);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    }
+    cfg_reader_init(rd, prior);
+    cfg->reader = rd;
+  }
+  else if (rd->prior != prior) {
+    cfg_msg(cfg, "inconsistent priority for configuration stream", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  CFG_STAT_ADD(cfg, nbyte, len);
+  return len ? cfg_reader_push(cfg, rd, data, len) : 0;
+}
+
+/******************************************************************************
+Function `cfg_feed_end`:
+  Finish parsing the streamed configuration text.
+Arguments:
+  * `cfg`:      entry for the configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_feed_end(cfg_t *cfg) {
+  if (!cfg) return CFG_ERR_INIT;
+  cfg_reader_t *rd = (cfg_reader_t *) cfg->reader;
+  if (!rd) return CFG_ERRNO(cfg);               /* no stream is open */
+  cfg->reader = NULL;
+
+  int err = CFG_ERRNO(cfg);
+  if (!err) err = cfg_reader_finish(cfg, rd);
+  else cfg_reader_release(cfg, rd);
+  cfg_free(cfg->alloc, rd);
+  return err;
+}
+
+
+/*============================================================================*\
+              Functions for reloading watched configuration files
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_watch_resize`:
+  Make sure that the states of entries of a watched file cover all the
+  registered parameters.
+Arguments:
+  * `file`:     the watched file;
+  * `npar`:     number of registered parameters;
+  * `alloc`:    the allocation functions.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_watch_resize(cfg_watch_file_t *file, const int npar,
+    const cfg_allocator_t *alloc) {
+  if (file->npar >= npar) return 0;
+  cfg_watch_entry_t *tmp = cfg_realloc(alloc, file->entry,
+      (size_t) npar * sizeof(cfg_watch_entry_t));
+  if (!tmp) return CFG_ERR_MEMORY;
+  memset(tmp + file->npar, 0, (npar - file->npar) * sizeof(cfg_watch_entry_t));
+  file->entry = tmp;
+  file->npar = npar;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_reload_entry`:
+  Convert the new value of a parameter into scratch memory, and replace the
+  current value only on success.  The replaced value is released if it was
+  allocated for the watched file.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `par`:      the parameter;
+  * `value`:    the new value;
+  * `prior`:    priority of the value;
+  * `owned`:    true if the current value is set by the watched file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_reload_entry(cfg_t *cfg, cfg_param_valid_t *par, char *value,
+    const int prior, const bool owned) {
+  union {
+    bool b; char c; int i; long l; float f; double d; void *p;
+  } tmp, old;
+  const size_t size = CFG_DTYPE_IS_ARRAY(par->dtype) ? sizeof(void *) :
+      cfg_dtype_size(par->dtype);
+  void *var = par->var, *mem = par->mem;
+  const size_t msize = par->msize;
+  const int narr = par->narr;
+  memcpy(&tmp, var, size);
+  old = tmp;
+
+  /* Memory of the current value must not be reused by the conversion. */
+  par->var = &tmp;
+  par->mem = NULL;
+  par->msize = 0;
+  par->value = value;
+  par->vlen = strlen(value) + 1;
+  const int err = cfg_get(cfg, par, prior);
+  par->var = var;
+
+  if (err) {
+    if (cfg->arena) cfg_arena_release(cfg->arena, par->mem, par->msize);
+    else if (par->dtype == CFG_DTYPE_STR && !cfg->source && tmp.p)
+      cfg_free(cfg->alloc, tmp.p);
+    par->mem = mem;
+    par->msize = msize;
+    par->narr = narr;
+    return err;
+  }
+  if (!par->mem) {              /* no new memory is taken for the value */
+    par->mem = mem;
+    par->msize = msize;
+  }
+  else cfg_arena_release(cfg->arena, mem, msize);
+  memcpy(var, &tmp, size);
+  par->src = prior;
+
+  /* Release the replaced value, unless it is in the arena or the kept text.
+     Elements of string arrays share the memory of the first one. */
+  if (cfg->arena || !owned) return 0;
+  if (CFG_DTYPE_IS_ARRAY(par->dtype) && old.p) {
+    if (par->dtype == CFG_ARRAY_STR && !cfg->source && narr > 0 &&
+        *((char **) old.p))
+      cfg_free(cfg->alloc, *((char **) old.p));
+    cfg_free(cfg->alloc, old.p);
+  }
+  else if (par->dtype == CFG_DTYPE_STR && !cfg->source && old.p)
+    cfg_free(cfg->alloc, old.p);
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_watch_apply`:
+  Assign the values of entries of a watched file that are changed since the
+  previous load, and record the variables that are updated.  On the first
+  load, the result is the same as that of `cfg_read_file`.  On reloads,
+  invalid values are reported as warnings, and the previous values are kept.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `watch`:    the watched files;
+  * `file`:     the watched file;
+  * `load`:     the loaded configuration file;
+  * `reload`:   true if the file has been loaded before.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_watch_apply(cfg_t *cfg, cfg_watch_t *watch,
+    cfg_watch_file_t *file, const cfg_file_t *load, const bool reload) {
+  if (cfg_watch_resize(file, cfg->npar, cfg->alloc)) {
+    cfg_msg(cfg, "failed to allocate memory for watching the file",
+        file->fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  for (int j = 0; j < file->npar; j++)
+    file->entry[j].flag &= ~CFG_WATCH_SEEN;
+
+  for (size_t i = 0; i < load->num; i++) {
+    const cfg_entry_t *entry = load->entry + i;
+    char msg[CFG_NUM_MAX_SIZE(size_t)];
+    if (entry->status == CFG_PARSE_ERROR) {
+      sprintf(msg, "%zu", entry->nline);
+      cfg_msg(cfg, "invalid configuration entry at line", msg);
+      continue;
+    }
+    if (entry->status != CFG_PARSE_DONE) {
+      sprintf(msg, "%d", entry->status);
+      cfg_msg(cfg, "unknown line parser status", msg);
+      return CFG_ERRNO(cfg) = CFG_ERR_UNKNOWN;
+    }
+
+    const int j = cfg_find_name(cfg, entry->key);
+    if (j == CFG_HASH_EMPTY) {
+      cfg_msg(cfg, "unregistered parameter name", entry->key);
+      continue;
+    }
+    cfg_watch_entry_t *state = file->entry + j;
+    if (state->flag & CFG_WATCH_SEEN) {       /* duplicate in the file */
+      cfg_msg(cfg, "omitting duplicate entry of parameter", entry->key);
+      continue;
+    }
+    state->flag |= CFG_WATCH_SEEN;
+
+    /* Skip values that are not changed since the previous load. */
+    size_t len;
+    const uint32_t hash = cfg_hash_str(entry->value, &len);
+    if ((state->flag & CFG_WATCH_PRESENT) && state->hash == hash &&
+        state->vlen == len) continue;
+    state->hash = hash;
+    state->vlen = len;
+
+    /* Values set previously by this file can be replaced. */
+    const int src = CFG_SRC_VAL(params[j].src);
+    if (src > file->prior) continue;
+    if (src == file->prior && !(state->flag & CFG_WATCH_OWNED)) {
+      cfg_msg(cfg, "omitting duplicate entry of parameter", entry->key);
+      continue;
+    }
+    if (!reload) {
+      params[j].value = entry->value;
+      params[j].vlen = len;
+      if (cfg_get(cfg, params + j, file->prior)) return CFG_ERRNO(cfg);
+      params[j].src = file->prior;
+    }
+    else if (cfg_reload_entry(cfg, params + j, entry->value, file->prior,
+        src == file->prior && (state->flag & CFG_WATCH_OWNED))) {
+      if (CFG_ERRNO(cfg) == CFG_ERR_MEMORY) return CFG_ERRNO(cfg);
+      CFG_ERRNO(cfg) = 0;       /* keep the previous value as a warning */
+      continue;
+    }
+    state->flag |= CFG_WATCH_OWNED;
+
+    if (watch->nvar == watch->vcap) {
+      const size_t cap = cfg_grow_size(watch->vcap, watch->nvar + 1,
+          sizeof(void *));
+      const void **tmp = cap ?
+          cfg_realloc(cfg->alloc, watch->var, cap * sizeof(void *)) : NULL;
+      if (!tmp) {
+        cfg_msg(cfg, "failed to allocate memory for watching the file",
+            file->fname);
+        return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+      }
+      watch->var = tmp;
+      watch->vcap = cap;
+    }
+    watch->var[watch->nvar++] = params[j].var;
+  }
+
+  /* Entries removed from the file keep their values. */
+  for (int j = 0; j < file->npar; j++) {
+    if (file->entry[j].flag & CFG_WATCH_SEEN)
+      file->entry[j].flag |= CFG_WATCH_PRESENT;
+    else file->entry[j].flag &= ~CFG_WATCH_PRESENT;
+  }
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_watch_load`:
+  Read a watched file, and assign the values that are changed.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `watch`:    the watched files;
+  * `file`:     the watched file;
+  * `reload`:   true if the file has been loaded before.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_watch_load(cfg_t *cfg, cfg_watch_t *watch,
+    cfg_watch_file_t *file, const bool reload) {
+  cfg_file_t load;
+  load.fname = file->fname;
+  load.buf = NULL;
+  load.entry = NULL;
+  load.len = load.num = load.cap = 0;
+  load.err = 0;
+  load.msg = NULL;
+  load.alloc = cfg->alloc;
+  load.timed = false;
+  cfg_file_load(&load);
+
+  int err = 0;
+  const size_t nvar = watch->nvar;
+  if (load.err) {
+    cfg_msg(cfg, load.msg, load.fname);
+    /* The file may be replaced later, so read errors are not fatal. */
+    if (!reload || load.err == CFG_ERR_MEMORY) err = CFG_ERRNO(cfg) = load.err;
+  }
+  else {
+    /* Files saved without changes are skipped, as are their warnings. */
+    const uint32_t hash = cfg_hash_mem(CFG_HASH_OFFSET, load.buf, load.len);
+    if (!reload || hash != file->hash || load.len != file->len)
+      err = cfg_watch_apply(cfg, watch, file, &load, reload);
+    file->hash = hash;
+    file->len = load.len;
+  }
+
+  /* String values may point to the text, if there is any new value. */
+  if (load.buf) {
+    if (cfg->source && (!reload || watch->nvar > nvar) && !load.err) {
+      if (cfg_source_add(cfg, load.buf, 0) && !err) err = CFG_ERRNO(cfg);
+    }
+    else cfg_free(cfg->alloc, load.buf);
+  }
+  if (load.entry) cfg_free(cfg->alloc, load.entry);
+  return err;
+}
+
+/******************************************************************************
+Function `cfg_watch_file`:
+  Read configuration parameters from a file, and watch the file for changes,
+  which are applied by `cfg_reload`.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the input file;
+  * `prior`:    priority of values read from this file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_watch_file(cfg_t *cfg, const char *fname, const int prior) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->npar <= 0) {
+    cfg_msg(cfg, "no parameter has been registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
+  }
+  if (!fname || *fname == '\0') {
+    cfg_msg(cfg, "the input configuration file is not set", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  const size_t len = cfg_strnlen(fname, CFG_MAX_FILENAME_LEN);
+  if (!len) {
+    cfg_msg(cfg, "invalid filename of the configuration file", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  if (prior <= CFG_SRC_NULL) {
+    cfg_msg(cfg, "invalid priority for configuration file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  /* Initialise the list of watched files. */
+  cfg_watch_t *watch = (cfg_watch_t *) cfg->watch;
+  if (!watch) {
+    if (!(watch = cfg_calloc(cfg->alloc, 1, sizeof(cfg_watch_t)))) {
+      cfg_msg(cfg, "failed to allocate memory for watching the file", fname);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    }
+    watch->file = NULL;
+    watch->var = NULL;
+#ifdef CFG_ENABLE_INOTIFY
+    if ((watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1) {
+      cfg_free(cfg->alloc, watch);
+      cfg_msg(cfg, "failed to initialise inotify for the file", fname);
+      return CFG_ERRNO(cfg) = CFG_ERR_FILE;
+    }
+#else
+    watch->fd = -1;
+#endif
+    cfg->watch = watch;
+  }
+  if (watch->num == watch->cap) {
+    const size_t cap = cfg_grow_size(watch->cap, watch->num + 1,
+        sizeof(cfg_watch_file_t));
+    cfg_watch_file_t *tmp = cap ?
+        cfg_realloc(cfg->alloc, watch->file, cap * sizeof(cfg_watch_file_t)) :
+        NULL;
+    if (!tmp) {
+      cfg_msg(cfg, "failed to allocate memory for watching the file", fname);
+      return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    }
+    watch->file = tmp;
+    watch->cap = cap;
+  }
+
+  cfg_watch_file_t *file = watch->file + watch->num;
+  if (!(file->fname = cfg_malloc(cfg->alloc, len))) {
+    cfg_msg(cfg, "failed to allocate memory for watching the file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  memcpy(file->fname, fname, len);
+  file->entry = NULL;
+  file->npar = 0;
+  file->prior = prior;
+  file->wd = -1;
+  file->dirty = false;
+  file->hash = 0;
+  file->len = 0;
+
+  /* Watch the directory, since editors may replace the file on saving. */
+  const char *base = strrchr(file->fname, '/');
+  file->base = base ? base + 1 : file->fname;
+#ifdef CFG_ENABLE_INOTIFY
+  char dir[CFG_MAX_FILENAME_LEN] = ".";
+  if (base) {
+    const size_t dlen = (base == file->fname) ? 1 : base - file->fname;
+    memcpy(dir, file->fname, dlen);
+    dir[dlen] = '\0';
+  }
+  if ((file->wd = inotify_add_watch(watch->fd, dir,
+      IN_CLOSE_WRITE | IN_MOVED_TO)) == -1) {
+    cfg_free(cfg->alloc, file->fname);
+    cfg_msg(cfg, "failed to watch the directory of the file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
+  }
+#endif
+  watch->num += 1;
+  return cfg_watch_load(cfg, watch, file, false);
+}
+
+/******************************************************************************
+Function `cfg_watch_fd`:
+  Return the file descriptor that becomes readable when watched files are
+  modified, for `poll` or `select`.
+Arguments:
+  * `cfg`:      entry for the configurations.
+Return:
+  The file descriptor; -1 if it is not available.
+******************************************************************************/
+int cfg_watch_fd(const cfg_t *cfg) {
+  if (!cfg || !cfg->watch) return -1;
+  return ((cfg_watch_t *) cfg->watch)->fd;
+}
+
+/******************************************************************************
+Function `cfg_reload`:
+  Apply changes of the watched files, by converting only the entries with
+  new values.  Without inotify, all the watched files are checked.  The
+  replaced strings and arrays are released.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `var`:      addresses of the updated variables on output, which are
+                valid until the next call of this function.
+Return:
+  Number of updated variables on success; negative on error.
+******************************************************************************/
+int cfg_reload(cfg_t *cfg, const void *const **var) {
+  if (var) *var = NULL;
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  cfg_watch_t *watch = (cfg_watch_t *) cfg->watch;
+  if (!watch) return 0;
+  watch->nvar = 0;
+
+#ifdef CFG_ENABLE_INOTIFY
+  /* Find the modified files from the pending events. */
+  union {
+    struct inotify_event event;
+    char buf[CFG_WATCH_BUF_SIZE];
+  } ev;
+  ssize_t len;
+  while ((len = read(watch->fd, ev.buf, sizeof ev.buf)) > 0) {
+    for (char *p = ev.buf; p < ev.buf + len;
+        p += sizeof(struct inotify_event) + ((struct inotify_event *) p)->len) {
+      const struct inotify_event *event = (struct inotify_event *) p;
+      for (size_t i = 0; i < watch->num; i++) {
+        cfg_watch_file_t *file = watch->file + i;
+        if ((event->mask & IN_Q_OVERFLOW) || (event->wd == file->wd &&
+            event->len && !strcmp(event->name, file->base)))
+          file->dirty = true;
+      }
+    }
+  }
+#else
+  for (size_t i = 0; i < watch->num; i++) watch->file[i].dirty = true;
+#endif
+
+  for (size_t i = 0; i < watch->num; i++) {
+    cfg_watch_file_t *file = watch->file + i;
+    if (!file->dirty) continue;
+    file->dirty = false;
+    if (cfg_watch_load(cfg, watch, file, true)) return CFG_ERRNO(cfg);
+  }
+  if (var) *var = watch->var;
+  return (int) watch->nvar;
+}
+
+
+/*============================================================================*\
+              Functions for caching the parsed configurations
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_hash_text`:
+  Compute the 64-bit hash value of a text, by mixing 8 bytes at once.  It is
+  only for detecting changes, and depends on the byte order.
+Arguments:
+  * `hash`:     the initial hash value;
+  * `src`:      the text;
+  * `size`:     number of bytes of the text.
+Return:
+  The hash value.
+******************************************************************************/
+static uint64_t cfg_hash_text(uint64_t hash, const void *src, size_t size) {
+  const unsigned char *p = (const unsigned char *) src;
+  for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(uint64_t));
+    hash = (hash ^ word) * CFG_HASH64_PRIME;
+    hash ^= hash >> 32;
+    p += sizeof(uint64_t);
+  }
+  while (size--) hash = (hash ^ *p++) * CFG_HASH64_PRIME;
+  return hash;
+}
+
+/******************************************************************************
+Function `cfg_cache_stamp`:
+  Record the size, modification time, and hash value of a source file.
+Arguments:
+  * `fname`:    name of the source file;
+  * `stamp`:    the record of the file;
+  * `ref`:      the record to be compared with, or NULL;
+  * `alloc`:    the allocation functions.
+Return:
+  Zero on success; 1 if the file differs from `ref`; negative on error.
+******************************************************************************/
+static int cfg_cache_stamp(const char *fname, cfg_cache_file_t *stamp,
+    const cfg_cache_file_t *ref, const cfg_allocator_t *alloc) {
+  stamp->sec = stamp->nsec = 0;
+#ifdef CFG_ENABLE_POSIX
+  /* Changes of the size and modification time are detected first. */
+  struct stat st;
+  if (stat(fname, &st)) return CFG_ERR_FILE;
+  stamp->sec = st.st_mtim.tv_sec;
+  stamp->nsec = st.st_mtim.tv_nsec;
+  if (ref && ((uint64_t) st.st_size != ref->size || stamp->sec != ref->sec ||
+      stamp->nsec != ref->nsec)) return 1;
+#endif
+
+  FILE *fp = fopen(fname, "rb");
+  if (!fp) return CFG_ERR_FILE;
+  char *buf = cfg_malloc(alloc, CFG_CACHE_CHUNK_SIZE);
+  if (!buf) {
+    fclose(fp);
+    return CFG_ERR_MEMORY;
+  }
+  uint64_t hash = CFG_HASH64_OFFSET;
+  size_t cnt, size = 0;
+  while ((cnt = fread(buf, sizeof(char), CFG_CACHE_CHUNK_SIZE, fp))) {
+    hash = cfg_hash_text(hash, buf, cnt);
+    size += cnt;
+  }
+  const bool eof = feof(fp);
+  cfg_free(alloc, buf);
+  fclose(fp);
+  if (!eof) return CFG_ERR_FILE;
+  stamp->size = size;
+  stamp->hash = hash;
+  if (ref && (stamp->size != ref->size || stamp->hash != ref->hash)) return 1;
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_cache_size`:
+  Compute the number of bytes of the cached value of a parameter.
+Arguments:
+  * `par`:      the parameter.
+Return:
+  Size of the value; for string arrays, the size of all the strings.
+******************************************************************************/
+static size_t cfg_cache_size(const cfg_param_valid_t *par) {
+  if (!CFG_DTYPE_IS_ARRAY(par->dtype)) {
+    if (par->dtype != CFG_DTYPE_STR) return cfg_dtype_size(par->dtype);
+    const char *str = *((char **) par->var);
+    return str ? strlen(str) + 1 : 0;
+  }
+  if (par->narr <= 0) return 0;
+  const cfg_dtype_t dtype = CFG_DTYPE_OF_ARRAY(par->dtype);
+  if (dtype != CFG_DTYPE_STR) return par->narr * cfg_dtype_size(dtype);
+  char **str = *((char ***) par->var);
+  size_t size = 0;
+  for (int i = 0; i < par->narr; i++) size += strlen(str[i]) + 1;
+  return size;
+}
+
+/******************************************************************************
+Function `cfg_cache_put`:
+  Copy data to the payload of the cache file, padded to 8 bytes.
+Arguments:
+  * `dst`:      the payload, or NULL for counting the size only;
+  * `pos`:      current size of the payload;
+  * `src`:      the data;
+  * `size`:     number of bytes of the data.
+Return:
+  Size of the payload after the copy.
+******************************************************************************/
+static size_t cfg_cache_put(char *dst, const size_t pos, const void *src,
+    const size_t size) {
+  const size_t len = CFG_CACHE_ROUND(size);
+  if (dst) {
+    if (size) memcpy(dst + pos, src, size);
+    memset(dst + pos + size, 0, len - size);
+  }
+  return pos + len;
+}
+
+/******************************************************************************
+Function `cfg_cache_fill`:
+  Serialize the records of the source files and parameters.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `dst`:      the payload, or NULL for counting the size only;
+  * `fnames`:   names of the source files;
+  * `stamp`:    records of the source files;
+  * `nfile`:    number of source files;
+  * `npar`:     number of parameter records on output.
+Return:
+  Size of the payload.
+******************************************************************************/
+static size_t cfg_cache_fill(const cfg_t *cfg, char *dst,
+    const char *const *fnames, const cfg_cache_file_t *stamp,
+    const int nfile, uint32_t *npar) {
+  size_t pos = 0;
+  for (int i = 0; i < nfile; i++) {
+    pos = cfg_cache_put(dst, pos, stamp + i, sizeof(cfg_cache_file_t));
+    pos = cfg_cache_put(dst, pos, fnames[i], stamp[i].nlen);
+  }
+
+  /* Only values from files are cached, as command line options may vary. */
+  const cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  *npar = 0;
+  for (int i = 0; i < cfg->npar; i++) {
+    const cfg_param_valid_t *par = params + i;
+    if (par->src <= CFG_SRC_NULL) continue;
+    cfg_cache_par_t rec;
+    memset(&rec, 0, sizeof(cfg_cache_par_t));
+    rec.dtype = par->dtype;
+    rec.src = par->src;
+    rec.nlen = par->nlen;
+    rec.narr = CFG_DTYPE_IS_ARRAY(par->dtype) ? par->narr : 1;
+    rec.size = cfg_cache_size(par);
+    if (!CFG_DTYPE_IS_ARRAY(par->dtype) && !rec.size) continue;
+    pos = cfg_cache_put(dst, pos, &rec, sizeof(cfg_cache_par_t));
+    pos = cfg_cache_put(dst, pos, par->name, par->nlen);
+
+    if (!CFG_DTYPE_IS_ARRAY(par->dtype)) {
+      const void *val = (par->dtype == CFG_DTYPE_STR) ?
+          (const void *) *((char **) par->var) : par->var;
+      pos = cfg_cache_put(dst, pos, val, rec.size);
+    }
+    else if (CFG_DTYPE_OF_ARRAY(par->dtype) != CFG_DTYPE_STR)
+      pos = cfg_cache_put(dst, pos, *((void **) par->var), rec.size);
+    else {              /* strings are concatenated and padded as a whole */
+      char **str = *((char ***) par->var);
+      size_t len = 0;
+      for (int j = 0; j < par->narr; j++) {
+        const size_t n = strlen(str[j]) + 1;
+        if (dst) memcpy(dst + pos + len, str[j], n);
+        len += n;
+      }
+      if (dst) memset(dst + pos + len, 0, CFG_CACHE_ROUND(len) - len);
+      pos += CFG_CACHE_ROUND(len);
+    }
+    *npar += 1;
+  }
+  return pos;
+}
+
+/******************************************************************************
+Function `cfg_write_cache`:
+  Save the values read from configuration files to a binary cache file,
+  together with the records of the source files for validation.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `cache`:    name of the cache file;
+  * `fnames`:   names of the source files;
+  * `nfile`:    number of source files.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_write_cache(cfg_t *cfg, const char *cache, const char *const *fnames,
+    const int nfile) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (!cache || *cache == '\0' ||
+      !(cfg_strnlen(cache, CFG_MAX_FILENAME_LEN - 4))) {
+    cfg_msg(cfg, "invalid filename of the cache file", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+  if (nfile <= 0 || !fnames) {
+    cfg_msg(cfg, "the source files of the cache are not set", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  cfg_cache_file_t *stamp =
+    cfg_malloc(cfg->alloc, nfile * sizeof(cfg_cache_file_t));
+  if (!stamp) {
+    cfg_msg(cfg, "failed to allocate memory for the cache file", cache);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  for (int i = 0; i < nfile; i++) {
+    int err = CFG_ERR_INPUT;
+    if (!fnames[i] ||
+        !(stamp[i].nlen = cfg_strnlen(fnames[i], CFG_MAX_FILENAME_LEN)) ||
+        (err = cfg_cache_stamp(fnames[i], stamp + i, NULL, cfg->alloc))) {
+      cfg_free(cfg->alloc, stamp);
+      if (err == CFG_ERR_MEMORY)
+        cfg_msg(cfg, "failed to allocate memory for the cache file", cache);
+      else cfg_msg(cfg, "cannot read the source file of the cache",
+          fnames[i]);
+      return CFG_ERRNO(cfg) = err;
+    }
+  }
+
+  /* Serialize the values, and write them to a temporary file that replaces
+     the cache at the end. */
+  cfg_cache_head_t head;
+  memset(&head, 0, sizeof(cfg_cache_head_t));
+  memcpy(head.magic, CFG_CACHE_MAGIC, sizeof head.magic);
+  head.version = CFG_CACHE_VERSION;
+  head.order = CFG_CACHE_ORDER;
+  head.layout = CFG_CACHE_LAYOUT;
+  head.nfile = nfile;
+  head.size = cfg_cache_fill(cfg, NULL, fnames, stamp, nfile, &head.npar);
+  char *buf = cfg_malloc(cfg->alloc, head.size);
+  if (!buf) {
+    cfg_free(cfg->alloc, stamp);
+    cfg_msg(cfg, "failed to allocate memory for the cache file", cache);
+    return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+  }
+  cfg_cache_fill(cfg, buf, fnames, stamp, nfile, &head.npar);
+  head.hash = cfg_hash_text(CFG_HASH64_OFFSET, buf, head.size);
+  cfg_free(cfg->alloc, stamp);
+
+  char tmp[CFG_MAX_FILENAME_LEN];
+  sprintf(tmp, "%s.tmp", cache);
+  FILE *fp = fopen(tmp, "wb");
+  if (!fp) {
+    cfg_free(cfg->alloc, buf);
+    cfg_msg(cfg, "cannot write to the cache file", tmp);
+    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
+  }
+  int err = (fwrite(&head, sizeof(cfg_cache_head_t), 1, fp) != 1 ||
+      fwrite(buf, head.size, 1, fp) != 1);
+  cfg_free(cfg->alloc, buf);
+  if (fclose(fp)) err = 1;
+  if (!err && rename(tmp, cache)) err = 1;
+  if (err) {
+    remove(tmp);
+    cfg_msg(cfg, "cannot write to the cache file", cache);
+    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
+  }
+  return 0;
+}
+
+/******************************************************************************
+Function `cfg_cache_load`:
+  Read the entire cache file into memory.
+Arguments:
+  * `cache`:    name of the cache file;
+  * `size`:     size of the file on output;
+  * `map`:      true if the file can be mapped into memory;
+  * `mapped`:   true on output if the file is mapped into memory;
+  * `alloc`:    the allocation functions.
+Return:
+  Address of the content on success; NULL if the file cannot be read.
+******************************************************************************/
+static char *cfg_cache_load(const char *cache, size_t *size, const bool map,
+    bool *mapped, const cfg_allocator_t *alloc) {
+  *size = 0;
+  *mapped = false;
+  FILE *fp = fopen(cache, "rb");
+  if (!fp) return NULL;
+  char *buf = NULL;
+#ifdef CFG_ENABLE_POSIX
+  struct stat st;
+  if (map && !fstat(fileno(fp), &st) && S_ISREG(st.st_mode) &&
+      st.st_size > 0 && (uintmax_t) st.st_size <= SIZE_MAX) {
+    buf = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+        fileno(fp), 0);
+    if (buf != MAP_FAILED) {
+      fclose(fp);
+      *size = st.st_size;
+      *mapped = true;
+      return buf;
+    }
+    buf = NULL;
+  }
+#else
+  (void) map;
+#endif
+  size_t cap = 0, len = 0, cnt = 0;
+  do {
+    len += cnt;
+    if (len == cap) {
+      const size_t num = cfg_grow_size(cap, cap + CFG_CACHE_CHUNK_SIZE, 1);
+      char *tmp = num ? cfg_realloc(alloc, buf, num) : NULL;
+      if (!tmp) break;
+      buf = tmp;
+      cap = num;
+    }
+  } while ((cnt = fread(buf + len, sizeof(char), cap - len, fp)));
+  if (!feof(fp) || !len) {
+    if (buf) cfg_free(alloc, buf);
+    buf = NULL;
+  }
+  fclose(fp);
+  *size = len;
+  return buf;
+}
+
+/******************************************************************************
+Function `cfg_cache_check`:
+  Validate a cache file against the source files and registered parameters.
+  The layout of the records is always checked, so that the values can be
+  applied safely even if the content is forged.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `buf`:      content of the cache file;
+  * `size`:     size of the cache file;
+  * `verify`:   true for verifying the hash value and source files.
+Return:
+  Zero if the cache is valid; 1 if it is outdated; negative on error.
+******************************************************************************/
+static int cfg_cache_check(const cfg_t *cfg, const char *buf,
+    const size_t size, const bool verify) {
+  const cfg_cache_head_t *head = (const cfg_cache_head_t *) buf;
+  if (size < sizeof(cfg_cache_head_t) ||
+      memcmp(head->magic, CFG_CACHE_MAGIC, sizeof head->magic) ||
+      head->version != CFG_CACHE_VERSION || head->order != CFG_CACHE_ORDER ||
+      head->layout != CFG_CACHE_LAYOUT ||
+      head->size != size - sizeof(cfg_cache_head_t)) return 1;
+  if (verify && head->hash != cfg_hash_text(CFG_HASH64_OFFSET,
+        buf + sizeof(cfg_cache_head_t), head->size)) return 1;
+
+  const char *p = buf + sizeof(cfg_cache_head_t), *end = buf + size;
+  for (uint32_t i = 0; i < head->nfile; i++) {
+    const cfg_cache_file_t *ref = (const cfg_cache_file_t *) p;
+    if ((size_t) (end - p) < sizeof(cfg_cache_file_t)) return 1;
+    p += sizeof(cfg_cache_file_t);
+    if (!ref->nlen || (uint64_t) (end - p) < ref->nlen ||
+        (uint64_t) (end - p) < CFG_CACHE_ROUND(ref->nlen) ||
+        p[ref->nlen - 1] != '\0') return 1;
+    if (verify) {
+      cfg_cache_file_t stamp;
+      const int err = cfg_cache_stamp(p, &stamp, ref, cfg->alloc);
+      if (err == CFG_ERR_MEMORY) return err;
+      if (err) return 1;
+    }
+    p += CFG_CACHE_ROUND(ref->nlen);
+  }
+
+  const cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  for (uint32_t i = 0; i < head->npar; i++) {
+    const cfg_cache_par_t *rec = (const cfg_cache_par_t *) p;
+    if ((size_t) (end - p) < sizeof(cfg_cache_par_t)) return 1;
+    p += sizeof(cfg_cache_par_t);
+    if (!rec->nlen || (uint64_t) (end - p) < rec->nlen ||
+        (uint64_t) (end - p) < CFG_CACHE_ROUND(rec->nlen) ||
+        p[rec->nlen - 1] != '\0') return 1;
+    const int j = cfg_find_name(cfg, p);
+    if (j == CFG_HASH_EMPTY || j >= cfg->npar ||
+        params[j].dtype != (cfg_dtype_t) rec->dtype ||
+        rec->src <= CFG_SRC_NULL || rec->narr > INT_MAX) return 1;
+    p += CFG_CACHE_ROUND(rec->nlen);
+    /* Sizes are compared before rounding, which may wrap around. */
+    if ((uint64_t) (end - p) < rec->size ||
+        (uint64_t) (end - p) < CFG_CACHE_ROUND(rec->size)) return 1;
+
+    /* Check the size of values, and the terminations of strings.  Scalars
+       are copied into the variables, so they must have exactly one element
+       of the registered size. */
+    cfg_dtype_t dtype = rec->dtype;
+    if (CFG_DTYPE_IS_ARRAY(dtype)) dtype = CFG_DTYPE_OF_ARRAY(dtype);
+    else if (rec->narr != 1) return 1;
+    if (dtype != CFG_DTYPE_STR) {
+      if (rec->size != rec->narr * cfg_dtype_size(dtype)) return 1;
+    }
+    else {
+      uint64_t num = 0;
+      for (uint64_t k = 0; k < rec->size; k++) if (p[k] == '\0') num++;
+      if (num != rec->narr || (rec->size && p[rec->size - 1] != '\0'))
+        return 1;
+    }
+    p += CFG_CACHE_ROUND(rec->size);
+  }
+  return (p == end) ? 0 : 1;
+}
+
+/******************************************************************************
+Function `cfg_cache_apply`:
+  Assign the cached values to the registered parameters, according to the
+  priorities of the sources.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `buf`:      content of the validated cache file;
+  * `prior`:    priority of the values; 0 for the cached priorities;
+  * `keep`:     true if strings can point to the content;
+  * `share`:    true if strings and arrays point to the shared content.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_cache_apply(cfg_t *cfg, char *buf, const int prior,
+    const bool keep, const bool share) {
+  const cfg_cache_head_t *head = (const cfg_cache_head_t *) buf;
+  char *p = buf + sizeof(cfg_cache_head_t);
+  for (uint32_t i = 0; i < head->nfile; i++)
+    p += sizeof(cfg_cache_file_t) +
+      CFG_CACHE_ROUND(((cfg_cache_file_t *) p)->nlen);
+
+  cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  for (uint32_t i = 0; i < head->npar; i++) {
+    const cfg_cache_par_t *rec = (const cfg_cache_par_t *) p;
+    p += sizeof(cfg_cache_par_t);
+    cfg_param_valid_t *par = params + cfg_find_name(cfg, p);
+    p += CFG_CACHE_ROUND(rec->nlen);
+    char *val = p;
+    p += CFG_CACHE_ROUND(rec->size);
+    const int src = prior ? prior : rec->src;
+    if (CFG_SRC_VAL(par->src) >= src) continue;
+
+    /* Values are copied without conversions. */
+    const size_t narr = rec->narr;
+    const size_t size = rec->size;
+    if (!CFG_DTYPE_IS_ARRAY(par->dtype)) {
+      if (par->dtype != CFG_DTYPE_STR) memcpy(par->var, val, size);
+      else if (keep || share) *((char **) par->var) = val;
+      else {
+        char *str = cfg_alloc_value(cfg, par, size, sizeof(char));
+        if (!str) goto memerr;
+        *((char **) par->var) = memcpy(str, val, size);
+      }
+    }
+    else if (narr && CFG_DTYPE_OF_ARRAY(par->dtype) != CFG_DTYPE_STR) {
+      if (share) {
+        *((void **) par->var) = val;
+        par->narr = narr;
+        par->src = src;
+        continue;
+      }
+      void *arr = cfg_alloc_value(cfg, par, size, sizeof(char));
+      if (!arr) goto memerr;
+      *((void **) par->var) = memcpy(arr, val, size);
+    }
+    else if (narr) {
+      /* The pointers and characters are in the same chunk of the arena. */
+      char **str;
+      char *chr = val;
+      if (cfg->arena) {
+        const size_t len = narr * sizeof(char *) +
+          ((keep || share) ? 0 : size);
+        if (!(str = cfg_alloc_value(cfg, par, len, sizeof(char))))
+          goto memerr;
+        if (!keep && !share) chr = memcpy((char *) (str + narr), val, size);
+      }
+      else if (share) {         /* the pointers are released with the cfg */
+        if (!(str = cfg_malloc(cfg->alloc, narr * sizeof(char *))))
+          goto memerr;
+        if (cfg_shared_add(cfg, str, 0)) {
+          cfg_free(cfg->alloc, str);
+          return CFG_ERRNO(cfg);
+        }
+      }
+      else {
+        if (!(str = cfg_malloc(cfg->alloc, narr * sizeof(char *))))
+          goto memerr;
+        if (!keep) {
+          if (!(chr = cfg_malloc(cfg->alloc, size))) {
+            cfg_free(cfg->alloc, str);
+            goto memerr;
+          }
+          memcpy(chr, val, size);
+        }
+      }
+      for (size_t k = 0; k < narr; k++) {
+        str[k] = chr;
+        chr += strlen(chr) + 1;
+      }
+      *((char ***) par->var) = str;
+    }
+    if (CFG_DTYPE_IS_ARRAY(par->dtype)) par->narr = narr;
+    par->src = src;
+  }
+  return 0;
+
+memerr:
+  cfg_msg(cfg, "failed to allocate memory for the cached values", NULL);
+  return CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+}
+
+/******************************************************************************
+Function `cfg_read_cache`:
+  Load the values saved by `cfg_write_cache`, if the source files and the
+  registered parameters are unchanged since the cache is written.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `cache`:    name of the cache file.
+Return:
+  Zero on success; 1 if the cache is missing or outdated, in which case no
+  value is loaded; negative on error.
+******************************************************************************/
+int cfg_read_cache(cfg_t *cfg, const char *cache) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->npar <= 0) {
+    cfg_msg(cfg, "no parameter has been registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
+  }
+  if (!cache || *cache == '\0' ||
+      !(cfg_strnlen(cache, CFG_MAX_FILENAME_LEN))) {
+    cfg_msg(cfg, "invalid filename of the cache file", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+
+  size_t size;
+  bool mapped;
+  /* The mapping is not kept, since it is still backed by the file. */
+  char *buf = cfg_cache_load(cache, &size, !cfg->source, &mapped, cfg->alloc);
+  if (!buf) return 1;
+  int err = cfg_cache_check(cfg, buf, size, true);
+  if (err < 0) {
+    cfg_msg(cfg, "failed to allocate memory for validating the cache", cache);
+    CFG_ERRNO(cfg) = err;
+  }
+  else if (!err) err = cfg_cache_apply(cfg, buf, 0, cfg->source != NULL,
+      false);
+
+  /* Strings may point to the content, if the source is kept. */
+#ifdef CFG_ENABLE_POSIX
+  if (err || !cfg->source) {
+    if (mapped) munmap(buf, size);
+    else cfg_free(cfg->alloc, buf);
+  }
+  else if (cfg_source_add(cfg, buf, 0)) err = CFG_ERRNO(cfg);
+#else
+  (void) mapped;
+  if (err || !cfg->source) cfg_free(cfg->alloc, buf);
+  else if (cfg_source_add(cfg, buf, 0)) err = CFG_ERRNO(cfg);
+#endif
+  return err;
+}
+
+/*============================================================================*\
+          Functions for sharing parsed configurations between processes
+\*============================================================================*/
+
+#ifdef CFG_ENABLE_POSIX
+/******************************************************************************
+Function `cfg_shared_name`:
+  Generate the name of the shared memory segment for a configuration file,
+  from the identity and modification time of the file.
+Arguments:
+  * `st`:       status of the configuration file;
+  * `name`:     the generated name.
+******************************************************************************/
+static void cfg_shared_name(const struct stat *st, char *name) {
+  const uint64_t key[7] = {st->st_dev, st->st_ino, st->st_size,
+    st->st_mtim.tv_sec, st->st_mtim.tv_nsec, geteuid(),
+    CFG_CACHE_VERSION | (uint64_t) CFG_CACHE_LAYOUT << 32};
+  sprintf(name, CFG_SHARED_PREFIX "%016llx",
+      (unsigned long long) cfg_hash_text(CFG_HASH64_OFFSET, key, sizeof key));
+}
+
+/******************************************************************************
+Function `cfg_shared_lock`:
+  Lock or unlock the shared memory segment, and wait for the lock.
+Arguments:
+  * `fd`:       file descriptor of the segment;
+  * `type`:     F_RDLCK, F_WRLCK, or F_UNLCK.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+static int cfg_shared_lock(const int fd, const short type) {
+  struct flock lock;
+  memset(&lock, 0, sizeof(struct flock));
+  lock.l_type = type;
+  lock.l_whence = SEEK_SET;
+  return fcntl(fd, F_SETLKW, &lock) == -1;
+}
+
+/******************************************************************************
+Function `cfg_shared_build`:
+  Parse a configuration file with private variables, and serialize the
+  values into a newly created shared memory segment.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the configuration file;
+  * `fd`:       file descriptor of the segment, locked for writing.
+Return:
+  Zero on success; non-zero if the file cannot be parsed.
+******************************************************************************/
+static int cfg_shared_build(cfg_t *cfg, const char *fname, const int fd) {
+  const cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+  cfg_param_t *par = cfg_calloc(cfg->alloc, cfg->npar, sizeof(cfg_param_t));
+  cfg_shared_var_t *var =
+    cfg_calloc(cfg->alloc, cfg->npar, sizeof(cfg_shared_var_t));
+  cfg_t *tmp = cfg_init_with_allocator(cfg->alloc);
+  int err = CFG_ERR_MEMORY;
+  if (!par || !var || !tmp) goto end;
+
+  /* Parameters without names are never read from files. */
+  int npar = 0;
+  for (int i = 0; i < cfg->npar; i++) {
+    if (!params[i].name) continue;
+    par[npar].name = params[i].name;
+    par[npar].dtype = params[i].dtype;
+    par[npar++].var = var + i;
+  }
+  tmp->nthread = cfg->nthread;
+  if ((err = cfg_use_arena(tmp)) || (err = cfg_set_params(tmp, par, npar)) ||
+      (err = cfg_read_file(tmp, fname, 1))) goto end;
+
+  cfg_cache_head_t head;
+  memset(&head, 0, sizeof(cfg_cache_head_t));
+  head.size = cfg_cache_fill(tmp, NULL, NULL, NULL, 0, &head.npar);
+  const size_t size = sizeof(cfg_cache_head_t) + head.size;
+  char *map;
+  err = CFG_ERR_FILE;
+  if (ftruncate(fd, size) || (map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0)) == MAP_FAILED) goto end;
+
+  /* The header is written last, so an incomplete segment is invalid. */
+  cfg_cache_fill(tmp, map + sizeof(cfg_cache_head_t), NULL, NULL, 0,
+      &head.npar);
+  memcpy(head.magic, CFG_CACHE_MAGIC, sizeof head.magic);
+  head.version = CFG_CACHE_VERSION;
+  head.order = CFG_CACHE_ORDER;
+  head.layout = CFG_CACHE_LAYOUT;
+  head.hash = cfg_hash_text(CFG_HASH64_OFFSET, map + sizeof(cfg_cache_head_t),
+      head.size);
+  memcpy(map, &head, sizeof(cfg_cache_head_t));
+  munmap(map, size);
+
+  /* Pass the warnings to the caller. */
+  const cfg_error_t *msg = (cfg_error_t *) tmp->error;
+  const char *str = msg->msg;
+  for (int i = 0; i < msg->num; i++) {
+    cfg_msg(cfg, str, NULL);
+    str += strlen(str) + 1;
+  }
+  err = 0;
+
+end:
+  if (par) cfg_free(cfg->alloc, par);
+  if (var) cfg_free(cfg->alloc, var);
+  cfg_destroy(tmp);
+  return err;
+}
+
+/******************************************************************************
+Function `cfg_shared_attach`:
+  Map a shared memory segment read-only, and assign the values to the
+  registered parameters.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `name`:     name of the segment;
+  * `prior`:    priority of the values.
+Return:
+  Zero on success; 1 if the segment is not ready; 2 if it is not usable;
+  negative on error.
+******************************************************************************/
+static int cfg_shared_attach(cfg_t *cfg, const char *name, const int prior) {
+  const int fd = shm_open(name, O_RDONLY, 0);
+  if (fd == -1) return 1;
+  if (cfg_shared_lock(fd, F_RDLCK)) {
+    close(fd);
+    return 2;
+  }
+
+  /* Wait until the segment is resized by the creator. */
+  struct stat st;
+  char *map = MAP_FAILED;
+  int err = 2;
+  if (fstat(fd, &st) || st.st_uid != geteuid() ||
+      (st.st_mode & (S_IWGRP | S_IWOTH))) err = 2;
+  else if (st.st_size == 0) err = 1;
+  else if ((uintmax_t) st.st_size <= SIZE_MAX) {
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map != MAP_FAILED) err = 0;
+  }
+  cfg_shared_lock(fd, F_UNLCK);
+  close(fd);
+  if (err) return err;
+
+  /* Segments left incomplete by failed creators are removed.  The hash
+     value is not verified, but malformed records are rejected. */
+  const size_t size = st.st_size;
+  const cfg_cache_head_t *head = (const cfg_cache_head_t *) map;
+  if (size < sizeof(cfg_cache_head_t) ||
+      memcmp(head->magic, CFG_CACHE_MAGIC, sizeof head->magic)) {
+    shm_unlink(name);
+    err = 2;
+  }
+  else if ((err = cfg_cache_check(cfg, map, size, false)) > 0) err = 2;
+  else if (err < 0) {
+    cfg_msg(cfg, "failed to allocate memory for the shared configurations",
+        NULL);
+    CFG_ERRNO(cfg) = err;
+  }
+  else if (cfg_shared_add(cfg, map, size)) err = CFG_ERRNO(cfg);
+  else return cfg_cache_apply(cfg, map, prior, false, true);
+  munmap(map, size);
+  return err;
+}
+#endif
+
+/******************************************************************************
+Function `cfg_read_shared`:
+  Read configuration parameters from a file, which is parsed only once by
+  co-located processes with CFG_ENABLE_POSIX.  The first process parses the
+  file into a shared memory segment, and the others attach to it.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the configuration file;
+  * `prior`:    priority of values read from this file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_read_shared(cfg_t *cfg, const char *fname, const int prior) {
+  /* Validate function arguments. */
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (cfg->npar <= 0) {
+    cfg_msg(cfg, "no parameter has been registered", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INIT;
+  }
+  if (!fname || *fname == '\0' ||
+      !(cfg_strnlen(fname, CFG_MAX_FILENAME_LEN)) || prior <= CFG_SRC_NULL)
+    return cfg_read_file(cfg, fname, prior);    /* report the error */
+
+#ifdef CFG_ENABLE_POSIX
+  struct stat st;
+  char name[CFG_SHARED_NAME_LEN];
+  if (stat(fname, &st) || !S_ISREG(st.st_mode))
+    return cfg_read_file(cfg, fname, prior);
+  cfg_shared_name(&st, name);
+
+  /* Parse the file privately if the segment cannot be used. */
+  int i;
+  for (i = 0; i < CFG_SHARED_MAX_WAIT; i++) {
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1) {
+      int err = cfg_shared_lock(fd, F_WRLCK);
+      if (!err && (err = cfg_shared_build(cfg, fname, fd))) {
+        shm_unlink(name);
+        if (ftruncate(fd, sizeof(cfg_cache_head_t))) err = CFG_ERR_FILE;
+      }
+      close(fd);                /* the lock is released as well */
+      if (err) break;
+    }
+    const int err = cfg_shared_attach(cfg, name, prior);
+    if (err <= 0) return err;
+    if (err == 2) break;
+    const struct timespec wait = {0, CFG_SHARED_WAIT_NSEC};
+    nanosleep(&wait, NULL);
+  }
+  /* The creator is gone before resizing the segment, as it is unlocked. */
+  if (i == CFG_SHARED_MAX_WAIT) shm_unlink(name);
+#endif
+  return cfg_read_file(cfg, fname, prior);
+}
+
+/******************************************************************************
+Function `cfg_unlink_shared`:
+  Remove the shared memory segment created for a configuration file.
+  Processes that are attached to it are not affected.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the configuration file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_unlink_shared(cfg_t *cfg, const char *fname) {
+  if (!cfg) return CFG_ERR_INIT;
+  if (CFG_IS_ERROR(cfg)) return CFG_ERRNO(cfg);
+  if (!fname || *fname == '\0' ||
+      !(cfg_strnlen(fname, CFG_MAX_FILENAME_LEN))) {
+    cfg_msg(cfg, "invalid filename of the configuration file", NULL);
+    return CFG_ERRNO(cfg) = CFG_ERR_INPUT;
+  }
+#ifdef CFG_ENABLE_POSIX
+  struct stat st;
+  char name[CFG_SHARED_NAME_LEN];
+  if (stat(fname, &st)) {
+    cfg_msg(cfg, "cannot open the configuration file", fname);
+    return CFG_ERRNO(cfg) = CFG_ERR_FILE;
+  }
+  cfg_shared_name(&st, name);
+  shm_unlink(name);             /* the segment may not exist */
+#endif
+  return 0;
+}
+
+/*============================================================================*\
+                 Functions for checking the status of variables
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_is_set`:
+  Check if a variable is set via the command line or files.
+Arguments:
+  * `cfg`:      entry of all configurations;
+  * `var`:      address of the variable.
+Return:
+  True if the variable is set; false otherwise.
+******************************************************************************/
+bool cfg_is_set(const cfg_t *cfg, const void *var) {
+  if (!cfg || !var || !cfg->npar) return false;
+  const int i = cfg_find_var(cfg, var);
+  /* Parameters of an unfinished registration are not visible. */
+  if (i == CFG_HASH_EMPTY || i >= cfg->npar) return false;
+  return ((cfg_param_valid_t *) cfg->params)[i].src != CFG_SRC_NULL;
+}
+
+/******************************************************************************
+Function `cfg_get_size`:
+  Return the number of elements for the parsed array.
+Arguments:
+  * `cfg`:      entry of all configurations;
+  * `var`:      address of the variable.
 Return:
   The number of array elements on success; 0 on error.
 ******************************************************************************/
 int cfg_get_size(const cfg_t *cfg, const void *var) {
   if (!cfg || !var || !cfg->npar) return 0;
+  const int i = cfg_find_var(cfg, var);
+  if (i == CFG_HASH_EMPTY || i >= cfg->npar) return 0;
+  const cfg_param_valid_t *par = (cfg_param_valid_t *) cfg->params + i;
+  return (par->src != CFG_SRC_NULL) ? par->narr : 0;
+}
+
+/******************************************************************************
+Function `cfg_get_status`:
+  Check the status of multiple variables at once.
+Arguments:
+  * `cfg`:      entry of all configurations;
+  * `var`:      addresses of the variables;
+  * `nvar`:     number of variables;
+  * `set`:      array for the flags indicating whether variables are set;
+  * `size`:     array for the number of elements of the parsed arrays.
+Return:
+  The number of variables that are set.
+******************************************************************************/
+int cfg_get_status(const cfg_t *cfg, const void *const *var, const int nvar,
+    bool *set, int *size) {
+  if (!var || nvar <= 0) return 0;
+  const cfg_param_valid_t *params = cfg ? (cfg_param_valid_t *) cfg->params :
+      NULL;
+  int num = 0;
+  for (int i = 0; i < nvar; i++) {
+    const cfg_param_valid_t *par = NULL;
+    if (params && var[i]) {
+      const int j = cfg_find_var(cfg, var[i]);
+      if (j != CFG_HASH_EMPTY && j < cfg->npar &&
+          params[j].src != CFG_SRC_NULL) par = params + j;
+    }
+    if (set) set[i] = (par != NULL);
+    if (size) size[i] = par ? par->narr : 0;
+    if (par) num++;
+  }
+  return num;
+}
+
+/******************************************************************************
+Function `cfg_get_stats`:
+  Retrieve the statistics collected since `cfg_use_stats`.
+Arguments:
+  * `cfg`:      entry of all configurations;
+  * `stats`:    structure for the statistics.
+Return:
+  Zero on success; non-zero if the statistics are not collected.
+******************************************************************************/
+int cfg_get_stats(const cfg_t *cfg, cfg_stats_t *stats) {
+  if (!cfg || !stats) return CFG_ERR_INIT;
+  if (!cfg->stats) return CFG_ERR_INPUT;
+  memcpy(stats, cfg->stats, sizeof(cfg_stats_t));
+  /* The error message is counted with the warnings by `cfg_msg`. */
+  if (CFG_IS_ERROR(cfg) && stats->nwarn) stats->nwarn -= 1;
+  return 0;
+}
+
+
+/*============================================================================*\
+            Functions for publishing snapshots to concurrent readers
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_snapshot_size`:
+  Compute the size of memory for copying the value of a parameter.
+Arguments:
+  * `par`:      the parameter.
+Return:
+  Size of the memory for the value, including the strings.
+******************************************************************************/
+static size_t cfg_snapshot_size(const cfg_param_valid_t *par) {
+  if (par->src == CFG_SRC_NULL) return 0;
+  if (!CFG_DTYPE_IS_ARRAY(par->dtype)) {
+    if (par->dtype != CFG_DTYPE_STR) return cfg_dtype_size(par->dtype);
+    const char *str = *((char **) par->var);
+    return str ? strlen(str) + 1 : 0;
+  }
+  if (par->narr <= 0) return 0;
+
+  const cfg_dtype_t dtype = CFG_DTYPE_OF_ARRAY(par->dtype);
+  size_t size = par->narr * cfg_dtype_size(dtype);
+  if (dtype == CFG_DTYPE_STR) {
+    char **str = *((char ***) par->var);
+    for (int i = 0; i < par->narr; i++)
+      if (str[i]) size += strlen(str[i]) + 1;
+  }
+  return size;
+}
+
+/******************************************************************************
+Function `cfg_snapshot_copy`:
+  Copy the value of a parameter to the memory of a snapshot.
+Arguments:
+  * `par`:      the parameter;
+  * `dst`:      the snapshot of the parameter;
+  * `mem`:      memory with the size given by `cfg_snapshot_size`.
+******************************************************************************/
+static void cfg_snapshot_copy(const cfg_param_valid_t *par,
+    cfg_snapshot_par_t *dst, char *mem) {
+  if (!CFG_DTYPE_IS_ARRAY(par->dtype)) {
+    if (par->dtype != CFG_DTYPE_STR)
+      memcpy(mem, par->var, cfg_dtype_size(par->dtype));
+    else strcpy(mem, *((char **) par->var));
+    dst->narr = 1;
+    dst->value = mem;
+    return;
+  }
+
+  const cfg_dtype_t dtype = CFG_DTYPE_OF_ARRAY(par->dtype);
+  const size_t size = par->narr * cfg_dtype_size(dtype);
+  memcpy(mem, *((void **) par->var), size);
+  if (dtype == CFG_DTYPE_STR) {
+    char **str = (char **) mem;
+    char *p = mem + size;
+    for (int i = 0; i < par->narr; i++) {
+      if (!str[i]) continue;
+      const size_t len = strlen(str[i]) + 1;
+      memcpy(p, str[i], len);
+      str[i] = p;
+      p += len;
+    }
+  }
+  dst->narr = par->narr;
+  dst->value = mem;
+}
+
+/******************************************************************************
+Function `cfg_snapshot_new`:
+  Copy the values of all the registered parameters to an immutable snapshot,
+  which does not depend on the entry or the variables afterwards.
+Arguments:
+  * `cfg`:      entry of all configurations.
+Return:
+  Address of the snapshot on success; NULL on error.
+******************************************************************************/
+cfg_snapshot_t *cfg_snapshot_new(cfg_t *cfg) {
+  if (!cfg || CFG_IS_ERROR(cfg)) return NULL;
+  const cfg_param_valid_t *params = (cfg_param_valid_t *) cfg->params;
+
+  /* Compute the size of the block, with the hash table for names. */
+  size_t cap = CFG_HASH_INIT_SIZE;
+  while (cap < (size_t) cfg->npar << 1) cap <<= 1;
+  const size_t head = CFG_ARENA_ROUND(sizeof(cfg_snapshot_t));
+  const size_t psize = CFG_ARENA_ROUND(cfg->npar * sizeof(cfg_snapshot_par_t));
+  const size_t hsize = CFG_ARENA_ROUND(cap * sizeof(cfg_hash_slot_t));
+  size_t size = head + psize + hsize;
   for (int i = 0; i < cfg->npar; i++) {
-    cfg_param_valid_t *par = (cfg_param_valid_t *) cfg->params + i;
-    if (par->var == var) {
-      if (par->src != CFG_SRC_NULL) return par->narr;
-      break;
+    size += CFG_ARENA_ROUND(params[i].nlen);
+    size += CFG_ARENA_ROUND(cfg_snapshot_size(params + i));
+  }
+
+  char *mem = cfg_malloc(cfg->alloc, size);
+  if (!mem) {
+    cfg_msg(cfg, "failed to allocate memory for the snapshot", NULL);
+    CFG_ERRNO(cfg) = CFG_ERR_MEMORY;
+    return NULL;
+  }
+  cfg_snapshot_t *snap = (cfg_snapshot_t *) mem;
+  snap->npar = cfg->npar;
+  snap->epoch = 0;
+  snap->next = NULL;
+  /* The snapshot may outlive `cfg`, so the functions are copied. */
+  if (cfg->alloc) snap->alloc = *((cfg_allocator_t *) cfg->alloc);
+  else memset(&snap->alloc, 0, sizeof(cfg_allocator_t));
+  snap->par = (cfg_snapshot_par_t *) (mem + head);
+  snap->name.cap = cap;
+  snap->name.num = cfg->npar;
+  snap->name.slot = (cfg_hash_slot_t *) (mem + head + psize);
+  for (size_t i = 0; i < cap; i++) snap->name.slot[i].idx = CFG_HASH_EMPTY;
+
+  char *p = mem + head + psize + hsize;
+  for (int i = 0; i < cfg->npar; i++) {
+    cfg_snapshot_par_t *par = snap->par + i;
+    par->dtype = params[i].dtype;
+    par->src = params[i].src;
+    par->narr = 0;
+    par->nlen = params[i].nlen;
+    par->name = p;
+    par->value = NULL;
+    memcpy(p, params[i].name, par->nlen);
+    p += CFG_ARENA_ROUND(par->nlen);
+
+    const size_t vsize = cfg_snapshot_size(params + i);
+    if (vsize) cfg_snapshot_copy(params + i, par, p);
+    p += CFG_ARENA_ROUND(vsize);
+
+    size_t len;
+    const uint32_t hash = cfg_hash_str(par->name, &len);
+    size_t j = hash & (cap - 1);
+    while (snap->name.slot[j].idx != CFG_HASH_EMPTY) j = (j + 1) & (cap - 1);
+    snap->name.slot[j].hash = hash;
+    snap->name.slot[j].idx = i;
+  }
+  return snap;
+}
+
+/******************************************************************************
+Function `cfg_snapshot_get`:
+  Return the value of a parameter from a snapshot.
+Arguments:
+  * `snap`:     the snapshot;
+  * `name`:     the null terminated name of the parameter;
+  * `num`:      the number of elements on output, 1 for scalars.
+Return:
+  Address of the value, the string, or the first array element on success;
+  NULL if the parameter is not found, not set, or an empty array.
+******************************************************************************/
+const void *cfg_snapshot_get(const cfg_snapshot_t *snap, const char *name,
+    int *num) {
+  if (num) *num = 0;
+  if (!snap || !name) return NULL;
+  size_t len;
+  const uint32_t hash = cfg_hash_str(name, &len);
+  const cfg_hash_t *tab = &snap->name;
+
+  size_t i = hash & (tab->cap - 1);
+  while (tab->slot[i].idx != CFG_HASH_EMPTY) {
+    const cfg_snapshot_par_t *par = snap->par + tab->slot[i].idx;
+    if (tab->slot[i].hash == hash && par->nlen == len &&
+        !memcmp(par->name, name, len)) {
+      if (num) *num = par->narr;
+      return par->value;
+    }
+    i = (i + 1) & (tab->cap - 1);
+  }
+  return NULL;
+}
+
+/******************************************************************************
+Function `cfg_snapshot_free`:
+  Release the memory of a snapshot that is not published.
+Arguments:
+  * `snap`:     the snapshot.
+******************************************************************************/
+void cfg_snapshot_free(cfg_snapshot_t *snap) {
+  if (!snap) return;
+  if (snap->alloc.free) snap->alloc.free(snap, snap->alloc.ctx);
+  else free(snap);
+}
+
+#ifdef CFG_HAVE_PUBLISHER
+/******************************************************************************
+Function `cfg_publisher_init`:
+  Initialise the publisher of snapshots for a fixed number of readers.
+Arguments:
+  * `nreader`:  number of reader slots.
+Return:
+  Address of the publisher on success; NULL on error.
+******************************************************************************/
+cfg_publisher_t *cfg_publisher_init(const int nreader) {
+  if (nreader <= 0) return NULL;
+  cfg_publisher_t *pub = malloc(sizeof(cfg_publisher_t));
+  if (!pub) return NULL;
+  if (!(pub->slot = calloc(nreader, sizeof(cfg_reader_slot_t)))) {
+    free(pub);
+    return NULL;
+  }
+  pub->snap = pub->retired = NULL;
+  pub->epoch = 1;
+  pub->nreader = nreader;
+  return pub;
+}
+
+/******************************************************************************
+Function `cfg_publisher_reclaim`:
+  Release the retired snapshots that are no longer visible to any reader.
+Arguments:
+  * `pub`:      the publisher.
+Return:
+  Number of retired snapshots that are still in use.
+******************************************************************************/
+int cfg_publisher_reclaim(cfg_publisher_t *pub) {
+  if (!pub) return 0;
+  /* Readers that entered before a snapshot is retired have older epochs. */
+  size_t min = SIZE_MAX;
+  for (int i = 0; i < pub->nreader; i++) {
+    const size_t epoch = CFG_ATOMIC_LOAD(&pub->slot[i].epoch);
+    if (epoch && epoch < min) min = epoch;
+  }
+
+  int num = 0;
+  cfg_snapshot_t **prev = &pub->retired;
+  while (*prev) {
+    cfg_snapshot_t *snap = *prev;
+    if (snap->epoch <= min) {
+      *prev = snap->next;
+      cfg_snapshot_free(snap);
     }
+    else {
+      prev = &snap->next;
+      num++;
+    }
+  }
+  return num;
+}
+
+/******************************************************************************
+Function `cfg_publish`:
+  Replace the current snapshot, and retire the previous one, which is
+  released once all the readers holding it have finished.  Only one thread
+  may publish snapshots at a time.
+Arguments:
+  * `pub`:      the publisher;
+  * `snap`:     the new snapshot, which is owned by the publisher afterwards.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_publish(cfg_publisher_t *pub, cfg_snapshot_t *snap) {
+  if (!pub) return CFG_ERR_INIT;
+  if (!snap) return CFG_ERR_INPUT;
+  cfg_snapshot_t *old = CFG_ATOMIC_SWAP(&pub->snap, snap);
+  const size_t epoch = CFG_ATOMIC_INCR(&pub->epoch);
+  if (old) {
+    old->epoch = epoch;
+    old->next = pub->retired;
+    pub->retired = old;
   }
+  cfg_publisher_reclaim(pub);
   return 0;
 }
 
+/******************************************************************************
+Function `cfg_snapshot_acquire`:
+  Enter the read-side critical section, and return the current snapshot,
+  which remains valid until `cfg_snapshot_release` is called with the same
+  reader slot.  This function never blocks.
+Arguments:
+  * `pub`:      the publisher;
+  * `reader`:   index of the reader slot, owned by the calling thread.
+Return:
+  The current snapshot; NULL if there is none, or on error.
+******************************************************************************/
+const cfg_snapshot_t *cfg_snapshot_acquire(cfg_publisher_t *pub,
+    const int reader) {
+  if (!pub || reader < 0 || reader >= pub->nreader) return NULL;
+  CFG_ATOMIC_STORE(&pub->slot[reader].epoch, CFG_ATOMIC_LOAD(&pub->epoch));
+  return CFG_ATOMIC_LOAD(&pub->snap);
+}
+
+/******************************************************************************
+Function `cfg_snapshot_release`:
+  Leave the read-side critical section.
+Arguments:
+  * `pub`:      the publisher;
+  * `reader`:   index of the reader slot.
+******************************************************************************/
+void cfg_snapshot_release(cfg_publisher_t *pub, const int reader) {
+  if (!pub || reader < 0 || reader >= pub->nreader) return;
+  CFG_ATOMIC_CLEAR(&pub->slot[reader].epoch);
+}
+
+/******************************************************************************
+Function `cfg_publisher_destroy`:
+  Release the publisher and all its snapshots, when there is no reader.
+Arguments:
+  * `pub`:      the publisher.
+******************************************************************************/
+void cfg_publisher_destroy(cfg_publisher_t *pub) {
+  if (!pub) return;
+  while (pub->retired) {
+    cfg_snapshot_t *snap = pub->retired;
+    pub->retired = snap->next;
+    cfg_snapshot_free(snap);
+  }
+  cfg_snapshot_free(pub->snap);
+  free(pub->slot);
+  free(pub);
+}
+#endif
+
+
+/*============================================================================*\
+                Functions for writing traces for external viewers
+\*============================================================================*/
+
+/******************************************************************************
+Function `cfg_json_puts`:
+  Write a string to a stream as a JSON string, with quotation marks.
+Arguments:
+  * `fp`:       the output stream;
+  * `str`:      the null terminated string.
+******************************************************************************/
+static void cfg_json_puts(FILE *fp, const char *str) {
+  putc('"', fp);
+  for (; str && *str; str++) {
+    const unsigned char c = (unsigned char) *str;
+    if (c == '"' || c == '\\') fprintf(fp, "\\%c", c);
+    else if (c < ' ') fprintf(fp, "\\u%04x", c);
+    else putc(c, fp);
+  }
+  putc('"', fp);
+}
+
+/******************************************************************************
+Function `cfg_trace_chrome`:
+  Tracing callback that writes events in the JSON array format of the Chrome
+  trace viewer, which can also be loaded by Perfetto.
+Arguments:
+  * `event`:    the event to be written;
+  * `fp`:       the output stream, of type `FILE *`.
+******************************************************************************/
+void cfg_trace_chrome(const cfg_event_t *event, void *fp) {
+  static const char *dtype_name[] = {"null", "bool", "char", "int", "long",
+    "float", "double", "string", "bool[]", "char[]", "int[]", "long[]",
+    "float[]", "double[]", "string[]"};
+  FILE *out = (FILE *) fp;
+  if (!event || !out) return;
+#ifdef CFG_ENABLE_POSIX
+  const long pid = (long) getpid();
+#else
+  const long pid = 1;
+#endif
+
+  fputs("{\"name\":", out);
+  switch (event->type) {
+    case CFG_EVENT_FILE_OPEN:   cfg_json_puts(out, "open");     break;
+    case CFG_EVENT_CHUNK_READ:  cfg_json_puts(out, "read");     break;
+    case CFG_EVENT_CONVERT:     cfg_json_puts(out, event->name); break;
+    default:                    cfg_json_puts(out, "message");  break;
+  }
+  fprintf(out, ",\"cat\":\"libcfg\",\"pid\":%ld,\"tid\":%ld,\"ts\":%.3f",
+      pid, pid, event->start * 1e6);
+  if (event->type == CFG_EVENT_MESSAGE) fputs(",\"ph\":\"i\",\"s\":\"t\"", out);
+  else fprintf(out, ",\"ph\":\"X\",\"dur\":%.3f", event->duration * 1e6);
+
+  fputs(",\"args\":{", out);
+  switch (event->type) {
+    case CFG_EVENT_FILE_OPEN:
+      fputs("\"file\":", out);
+      cfg_json_puts(out, event->name);
+      break;
+    case CFG_EVENT_CHUNK_READ:
+      fputs("\"file\":", out);
+      cfg_json_puts(out, event->name);
+      fprintf(out, ",\"bytes\":%zu", event->num);
+      break;
+    case CFG_EVENT_CONVERT:
+      fprintf(out, "\"dtype\":\"%s\",\"elements\":%zu",
+          CFG_DTYPE_INVALID(event->dtype) ? "null" : dtype_name[event->dtype],
+          event->num);
+      break;
+    default:
+      fputs("\"message\":", out);
+      cfg_json_puts(out, event->name);
+      break;
+  }
+  fputs("}},\n", out);
+}
+
 
 /*============================================================================*\
                Functions for clean-up and error message handling
@@ -1397,12 +6099,51 @@ Arguments:
 ******************************************************************************/
 void cfg_destroy(cfg_t *cfg) {
   if (!cfg) return;
-  if (cfg->npar) free(cfg->params);
-  if (cfg->nfunc) free(cfg->funcs);
+  cfg_allocator_t *alloc = (cfg_allocator_t *) cfg->alloc;
+  if (cfg->params) cfg_free(alloc, cfg->params);
+  if (cfg->funcs) cfg_free(alloc, cfg->funcs);
+  cfg_reader_t *rd = cfg->reader;
+  if (rd) {
+    if (rd->buf) cfg_free(alloc, rd->buf);
+    cfg_free(alloc, rd);
+  }
+  if (cfg->source) cfg_source_free(cfg->source, alloc);
+  if (cfg->shared) cfg_source_free(cfg->shared, alloc);
+  if (cfg->stats) cfg_free(alloc, cfg->stats);
+  if (cfg->trace) cfg_free(alloc, cfg->trace);
+  cfg_watch_t *watch = cfg->watch;
+  if (watch) {
+#ifdef CFG_ENABLE_INOTIFY
+    close(watch->fd);
+#endif
+    for (size_t i = 0; i < watch->num; i++) {
+      cfg_free(alloc, watch->file[i].fname);
+      if (watch->file[i].entry) cfg_free(alloc, watch->file[i].entry);
+    }
+    if (watch->file) cfg_free(alloc, watch->file);
+    if (watch->var) cfg_free(alloc, watch->var);
+    cfg_free(alloc, watch);
+  }
+  cfg_arena_t *arena = cfg->arena;
+  if (arena) {
+    while (arena->block) {
+      cfg_arena_block_t *blk = arena->block;
+      arena->block = blk->next;
+      cfg_free(alloc, blk);
+    }
+    cfg_free(alloc, arena);
+  }
+  cfg_index_t *index = cfg->index;
+  if (index->name.slot) cfg_free(alloc, index->name.slot);
+  if (index->lopt.slot) cfg_free(alloc, index->lopt.slot);
+  if (index->func.slot) cfg_free(alloc, index->func.slot);
+  if (index->var.slot) cfg_free(alloc, index->var.slot);
+  cfg_free(alloc, cfg->index);
   cfg_error_t *err = cfg->error;
-  if (err->max) free(err->msg);
-  free(cfg->error);
-  free(cfg);
+  if (err->max) cfg_free(alloc, err->msg);
+  cfg_free(alloc, cfg->error);
+  cfg_free(alloc, cfg);
+  cfg_free(alloc, alloc);               /* released by itself at last */
 }
 
 /******************************************************************************
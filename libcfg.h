@@ -88,11 +88,67 @@ typedef enum {
 typedef struct {
   int npar;             /* number of verified configuration parameters  */
   int nfunc;            /* number of verified command line functions    */
+  int nthread;          /* maximum number of threads for large arrays   */
   void *params;         /* data structure for storing parameters        */
   void *funcs;          /* data structure for storing function pointers */
+  void *index;          /* data structure for indexing the parameters   */
+  void *reader;         /* data structure for streamed configurations   */
+  void *arena;          /* memory arena for the retrieved values        */
+  void *source;         /* retained buffers of the configuration text   */
+  void *watch;          /* configuration files watched for changes      */
+  void *shared;         /* mappings of shared parsed configurations     */
+  void *stats;          /* statistics of parsing the configurations     */
+  void *trace;          /* callback for tracing the parsing             */
+  void *alloc;          /* functions for memory allocation              */
   void *error;          /* data structure for storing error messages    */
 } cfg_t;
 
+/* Functions for memory allocation, with a context pointer. */
+typedef struct {
+  void *(*malloc) (size_t size, void *ctx);
+  void *(*realloc) (void *ptr, size_t size, void *ctx);
+  void (*free) (void *ptr, void *ctx);
+  void *ctx;                    /* context passed to the functions      */
+} cfg_allocator_t;
+
+/* Statistics of parsing, collected with CFG_ENABLE_STATS. */
+typedef struct {
+  size_t nbyte;                 /* number of bytes read                 */
+  size_t nline;                 /* number of lines                      */
+  size_t nentry;                /* number of entries and options        */
+  size_t ncont;                 /* number of continuation lines         */
+  size_t nrealloc;              /* number of chunk reallocations        */
+  size_t nmove;                 /* number of bytes moved within chunks  */
+  size_t nprobe;                /* number of probes for name lookups    */
+  size_t nwarn;                 /* number of warnings issued            */
+  size_t nalloc[CFG_ARRAY_STR + 1];     /* allocations per data type    */
+  size_t salloc[CFG_ARRAY_STR + 1];     /* bytes allocated per data type */
+  double t_io;                  /* seconds for reading files            */
+  double t_token;               /* seconds for tokenizing the text      */
+  double t_conv;                /* seconds for converting the values    */
+} cfg_stats_t;
+
+/* Types of events reported to the tracing callback. */
+typedef enum {
+  CFG_EVENT_FILE_OPEN,          /* a configuration file is opened       */
+  CFG_EVENT_CHUNK_READ,         /* a chunk of a file is read            */
+  CFG_EVENT_CONVERT,            /* the value of a parameter is converted */
+  CFG_EVENT_MESSAGE             /* a warning or error message is issued */
+} cfg_event_type_t;
+
+/* Event reported to the tracing callback. */
+typedef struct {
+  cfg_event_type_t type;        /* type of the event                    */
+  const char *name;             /* filename, parameter name, or message */
+  cfg_dtype_t dtype;            /* data type of the converted parameter */
+  size_t num;                   /* number of bytes read or elements     */
+  double start;                 /* starting time in seconds             */
+  double duration;              /* duration in seconds                  */
+} cfg_event_t;
+
+/* Callback for tracing the parsing. */
+typedef void (*cfg_trace_func_t) (const cfg_event_t *event, void *ctx);
+
 /* Interface for registering configuration parameters. */
 typedef struct {
   int opt;                      /* short command line option            */
@@ -102,6 +158,17 @@ typedef struct {
   void *var;                    /* variable for the retrieved value     */
 } cfg_param_t;
 
+/* Immutable snapshot of the parameter values. */
+typedef struct cfg_snapshot_struct cfg_snapshot_t;
+
+/* Publisher of snapshots for concurrent readers, which relies on atomic
+   operations of GCC compatible compilers, or C11. */
+typedef struct cfg_publisher_struct cfg_publisher_t;
+#if defined(__GNUC__) || (defined(__STDC_VERSION__) && \
+  __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__))
+#define CFG_HAVE_PUBLISHER
+#endif
+
 /* Interface for registering command line functions. */
 typedef struct {
   int opt;                      /* short command line option            */
@@ -123,6 +190,84 @@ Return:
 ******************************************************************************/
 cfg_t *cfg_init(void);
 
+/******************************************************************************
+Function `cfg_init_with_allocator`:
+  Initialise the entry for all parameters and command line functions, with
+  all the memory allocated by the given functions.
+Arguments:
+  * `alloc`:    the allocation functions, or NULL for the standard ones.
+Return:
+  The address of the structure; NULL on error.
+******************************************************************************/
+cfg_t *cfg_init_with_allocator(const cfg_allocator_t *alloc);
+
+/******************************************************************************
+Function `cfg_use_arena`:
+  Allocate memory for all the subsequently retrieved strings and arrays from
+  blocks owned by the entry, which are released by `cfg_destroy`.
+Arguments:
+  * `cfg`:      entry for all configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_use_arena(cfg_t *cfg);
+
+/******************************************************************************
+Function `cfg_keep_source`:
+  Keep the subsequently parsed configuration text alive until `cfg_destroy`,
+  and let string variables point directly to the values in it.
+Arguments:
+  * `cfg`:      entry for all configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_keep_source(cfg_t *cfg);
+
+/******************************************************************************
+Function `cfg_set_threads`:
+  Set the maximum number of threads for converting large numerical arrays,
+  which takes effect only with CFG_ENABLE_THREADS.
+Arguments:
+  * `cfg`:      entry for all configurations;
+  * `nthread`:  the maximum number of threads.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_set_threads(cfg_t *cfg, const int nthread);
+
+/******************************************************************************
+Function `cfg_use_stats`:
+  Start collecting statistics of the subsequent parsing, which takes effect
+  only with CFG_ENABLE_STATS.
+Arguments:
+  * `cfg`:      entry for all configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_use_stats(cfg_t *cfg);
+
+/******************************************************************************
+Function `cfg_set_trace`:
+  Register a callback for tracing the subsequent parsing, or remove it.
+Arguments:
+  * `cfg`:      entry for all configurations;
+  * `func`:     the callback function, or NULL for removing the callback;
+  * `ctx`:      context passed to the callback.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_set_trace(cfg_t *cfg, cfg_trace_func_t func, void *ctx);
+
+/******************************************************************************
+Function `cfg_trace_chrome`:
+  Tracing callback that writes events in the JSON array format of the Chrome
+  trace viewer, which can also be loaded by Perfetto.
+Arguments:
+  * `event`:    the event to be written;
+  * `fp`:       the output stream, of type `FILE *`.
+******************************************************************************/
+void cfg_trace_chrome(const cfg_event_t *event, void *fp);
+
 /******************************************************************************
 Function `cfg_set_params`:
   Verify and register configuration parameters.
@@ -174,6 +319,151 @@ Return:
 ******************************************************************************/
 int cfg_read_file(cfg_t *cfg, const char *fname, const int prior);
 
+/******************************************************************************
+Function `cfg_read_files`:
+  Read configuration parameters from multiple files, which are read
+  concurrently, and assigned in order as if `cfg_read_file` is called on each
+  of them.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fnames`:   names of the input files;
+  * `priors`:   priorities of values read from each file;
+  * `nfile`:    number of files;
+  * `nthread`:  maximum number of threads for reading files.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_read_files(cfg_t *cfg, const char *const *fnames, const int *priors,
+    const int nfile, const int nthread);
+
+/******************************************************************************
+Function `cfg_watch_file`:
+  Read configuration parameters from a file, and watch the file for changes,
+  which are applied by `cfg_reload`.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the input file;
+  * `prior`:    priority of values read from this file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_watch_file(cfg_t *cfg, const char *fname, const int prior);
+
+/******************************************************************************
+Function `cfg_watch_fd`:
+  Return the file descriptor that becomes readable when watched files are
+  modified, for `poll` or `select`.
+Arguments:
+  * `cfg`:      entry for the configurations.
+Return:
+  The file descriptor; -1 if it is not available.
+******************************************************************************/
+int cfg_watch_fd(const cfg_t *cfg);
+
+/******************************************************************************
+Function `cfg_reload`:
+  Apply changes of the watched files, by converting only the entries with
+  new values.  Without inotify, all the watched files are checked.  The
+  replaced strings and arrays are released.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `var`:      addresses of the updated variables on output, which are
+                valid until the next call of this function.
+Return:
+  Number of updated variables on success; negative on error.
+******************************************************************************/
+int cfg_reload(cfg_t *cfg, const void *const **var);
+
+/******************************************************************************
+Function `cfg_write_cache`:
+  Save the values read from configuration files to a binary cache file,
+  together with the size, modification time, and hash value of the files.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `cache`:    name of the cache file;
+  * `fnames`:   names of the configuration files that are read;
+  * `nfile`:    number of configuration files.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_write_cache(cfg_t *cfg, const char *cache, const char *const *fnames,
+    const int nfile);
+
+/******************************************************************************
+Function `cfg_read_cache`:
+  Load the values saved by `cfg_write_cache` without parsing, if the
+  configuration files and registered parameters are unchanged.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `cache`:    name of the cache file.
+Return:
+  Zero on success; 1 if the cache is missing or outdated; negative on error.
+******************************************************************************/
+int cfg_read_cache(cfg_t *cfg, const char *cache);
+
+/******************************************************************************
+Function `cfg_read_shared`:
+  Read configuration parameters from a file, which is parsed only once by
+  co-located processes with CFG_ENABLE_POSIX.  Strings and arrays point to
+  read-only shared memory, which is released by `cfg_destroy`.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the configuration file;
+  * `prior`:    priority of values read from this file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_read_shared(cfg_t *cfg, const char *fname, const int prior);
+
+/******************************************************************************
+Function `cfg_unlink_shared`:
+  Remove the shared memory segment created for a configuration file.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `fname`:    name of the configuration file.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_unlink_shared(cfg_t *cfg, const char *fname);
+
+/******************************************************************************
+Function `cfg_read_buffer`:
+  Read configuration parameters from a string in memory.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `buf`:      the configuration text, which is not modified;
+  * `len`:      length of the text;
+  * `prior`:    priority of values read from this string.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_read_buffer(cfg_t *cfg, const char *buf, const size_t len,
+    const int prior);
+
+/******************************************************************************
+Function `cfg_feed`:
+  Parse a fragment of streamed configuration text; incomplete lines are kept
+  until the following fragments or `cfg_feed_end` are supplied.
+Arguments:
+  * `cfg`:      entry for the configurations;
+  * `data`:     the fragment of configuration text, which is not modified;
+  * `len`:      length of the fragment;
+  * `prior`:    priority of values read from this stream.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_feed(cfg_t *cfg, const char *data, const size_t len, const int prior);
+
+/******************************************************************************
+Function `cfg_feed_end`:
+  Finish parsing the streamed configuration text.
+Arguments:
+  * `cfg`:      entry for the configurations.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_feed_end(cfg_t *cfg);
+
 /******************************************************************************
 Function `cfg_is_set`:
   Check if a variable is set via the command line or files.
@@ -196,6 +486,133 @@ Return:
 ******************************************************************************/
 int cfg_get_size(const cfg_t *cfg, const void *var);
 
+/******************************************************************************
+Function `cfg_get_status`:
+  Check the status of multiple variables at once.
+Arguments:
+  * `cfg`:      entry of all configurations;
+  * `var`:      addresses of the variables;
+  * `nvar`:     number of variables;
+  * `set`:      array for the flags indicating whether variables are set,
+                can be NULL;
+  * `size`:     array for the number of elements of the parsed arrays,
+                can be NULL.
+Return:
+  The number of variables that are set.
+******************************************************************************/
+int cfg_get_status(const cfg_t *cfg, const void *const *var, const int nvar,
+    bool *set, int *size);
+
+/******************************************************************************
+Function `cfg_get_stats`:
+  Retrieve the statistics collected since `cfg_use_stats`.
+Arguments:
+  * `cfg`:      entry of all configurations;
+  * `stats`:    structure for the statistics.
+Return:
+  Zero on success; non-zero if the statistics are not collected.
+******************************************************************************/
+int cfg_get_stats(const cfg_t *cfg, cfg_stats_t *stats);
+
+/******************************************************************************
+Function `cfg_snapshot_new`:
+  Copy the values of all the registered parameters to an immutable snapshot,
+  which does not depend on the entry or the variables afterwards.
+Arguments:
+  * `cfg`:      entry of all configurations.
+Return:
+  Address of the snapshot on success; NULL on error.
+******************************************************************************/
+cfg_snapshot_t *cfg_snapshot_new(cfg_t *cfg);
+
+/******************************************************************************
+Function `cfg_snapshot_get`:
+  Return the value of a parameter from a snapshot.
+Arguments:
+  * `snap`:     the snapshot;
+  * `name`:     the null terminated name of the parameter;
+  * `num`:      the number of elements on output, 1 for scalars, can be NULL.
+Return:
+  Address of the value, the string, or the first array element on success;
+  NULL if the parameter is not found, not set, or an empty array.
+******************************************************************************/
+const void *cfg_snapshot_get(const cfg_snapshot_t *snap, const char *name,
+    int *num);
+
+/******************************************************************************
+Function `cfg_snapshot_free`:
+  Release the memory of a snapshot that is not published.
+Arguments:
+  * `snap`:     the snapshot.
+******************************************************************************/
+void cfg_snapshot_free(cfg_snapshot_t *snap);
+
+#ifdef CFG_HAVE_PUBLISHER
+/******************************************************************************
+Function `cfg_publisher_init`:
+  Initialise the publisher of snapshots for a fixed number of readers.
+Arguments:
+  * `nreader`:  number of reader slots.
+Return:
+  Address of the publisher on success; NULL on error.
+******************************************************************************/
+cfg_publisher_t *cfg_publisher_init(const int nreader);
+
+/******************************************************************************
+Function `cfg_publish`:
+  Replace the current snapshot, and retire the previous one, which is
+  released once all the readers holding it have finished.  Only one thread
+  may publish snapshots at a time.
+Arguments:
+  * `pub`:      the publisher;
+  * `snap`:     the new snapshot, which is owned by the publisher afterwards.
+Return:
+  Zero on success; non-zero on error.
+******************************************************************************/
+int cfg_publish(cfg_publisher_t *pub, cfg_snapshot_t *snap);
+
+/******************************************************************************
+Function `cfg_publisher_reclaim`:
+  Release the retired snapshots that are no longer visible to any reader.
+Arguments:
+  * `pub`:      the publisher.
+Return:
+  Number of retired snapshots that are still in use.
+******************************************************************************/
+int cfg_publisher_reclaim(cfg_publisher_t *pub);
+
+/******************************************************************************
+Function `cfg_snapshot_acquire`:
+  Enter the read-side critical section, and return the current snapshot,
+  which remains valid until `cfg_snapshot_release` is called with the same
+  reader slot.  This function never blocks.
+Arguments:
+  * `pub`:      the publisher;
+  * `reader`:   index of the reader slot, owned by the calling thread.
+Return:
+  The current snapshot; NULL if there is none, or on error.
+******************************************************************************/
+const cfg_snapshot_t *cfg_snapshot_acquire(cfg_publisher_t *pub,
+    const int reader);
+
+/******************************************************************************
+Function `cfg_snapshot_release`:
+  Leave the read-side critical section.
+Arguments:
+  * `pub`:      the publisher;
+  * `reader`:   index of the reader slot.
+******************************************************************************/
+void cfg_snapshot_release(cfg_publisher_t *pub, const int reader);
+
+/******************************************************************************
+Function `cfg_publisher_destroy`:
+  Release the publisher and all its snapshots, when there is no reader.
+Arguments:
+  * `pub`:      the publisher.
+******************************************************************************/
+void cfg_publisher_destroy(cfg_publisher_t *pub);
+#endif
+
 /******************************************************************************
 Function `cfg_destroy`:
   Release memory allocated for the configuration parameters.